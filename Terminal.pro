@@ -8,13 +8,19 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(library/library.pri)
+
 SOURCES += \
-    library/firmwareuart.cpp \
+    library/consolerenderer.cpp \
+    library/hexview.cpp \
+    library/telemetryplot.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
-    library/firmwareuart.h \
+    library/consolerenderer.h \
+    library/hexview.h \
+    library/telemetryplot.h \
     mainwindow.h
 
 FORMS += \
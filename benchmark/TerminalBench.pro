@@ -0,0 +1,38 @@
+# Throughput and latency benchmarks for the FirmwareUART I/O path over Linux pseudo-terminals,
+# plus in-memory benchmarks of the frame decoders (--decoders), a many-port session
+# benchmark (--ports), a windowed firmware upload benchmark (--upload), a trigger
+# matching benchmark (--matchers), a transmit schedule jitter benchmark (--schedule)
+# and a telemetry parsing and plot decimation benchmark (--telemetry).
+QT       -= gui
+QT       += core serialport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = terminal-bench
+
+!linux: error("terminal-bench needs Linux pseudo-terminals")
+
+include(../library/library.pri)
+
+SOURCES += \
+    decoderbench.cpp \
+    main.cpp \
+    matcherbench.cpp \
+    ptyloopback.cpp \
+    schedulebench.cpp \
+    sessionbench.cpp \
+    telemetrybench.cpp \
+    uploadbench.cpp \
+    uploaddevice.cpp
+
+HEADERS += \
+    benchutil.h \
+    decoderbench.h \
+    matcherbench.h \
+    ptyloopback.h \
+    schedulebench.h \
+    sessionbench.h \
+    telemetrybench.h \
+    uploadbench.h \
+    uploaddevice.h
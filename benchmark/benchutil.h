@@ -0,0 +1,77 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <QByteArray>
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <vector>
+
+// Helpers shared by the terminal-bench cases: result rows, waiting on the event loop,
+// random payloads and percentiles.
+
+// One result row: comma-separated with --csv, otherwise right-aligned in columns of width.
+// suffix follows the last value as it is, for notes outside the table
+inline void printRow(QTextStream &out, bool csv, int width, const QStringList &values,
+                     const QString &suffix = QString()) {
+    if (csv) {
+        out << values.join(',');
+    } else {
+        for (const QString &value : values) {
+            out << QString("%1").arg(value, width);
+        }
+    }
+    out << suffix << Qt::endl;
+}
+
+// Runs the event loop until done() holds or timeoutMs passes. The 1 ms check adds a
+// small fixed CPU cost to every case, so compare runs rather than absolute numbers.
+template <typename Predicate>
+bool runUntil(Predicate done, int timeoutMs) {
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&] {
+        if (done()) {
+            loop.quit();
+        }
+    });
+    poll.start(1);
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    if (!done()) {
+        loop.exec();
+    }
+    return done();
+}
+
+// Runs the event loop for ms, so queued work on this thread keeps being serviced
+inline void runFor(int ms) {
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+// size random bytes; whole words come from fillRange(), the last size % 4 one at a time
+inline QByteArray randomBytes(qsizetype size) {
+    QByteArray data(size, Qt::Uninitialized);
+    const qsizetype words = size / 4;
+    QRandomGenerator::global()->fillRange(reinterpret_cast<quint32 *>(data.data()), words);
+    for (qsizetype i = words * 4; i < size; ++i) {
+        data[i] = char(QRandomGenerator::global()->bounded(256));
+    }
+    return data;
+}
+
+// The value percent of the way through values, 0 if there are none; reorders values
+inline qint64 percentile(std::vector<qint64> &values, int percent) {
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(values.size() - 1, values.size() * size_t(percent) / 100);
+    std::nth_element(values.begin(), values.begin() + qsizetype(index), values.end());
+    return values[index];
+}
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,100 @@
+#include "decoderbench.h"
+#include <QElapsedTimer>
+#include <memory>
+#include "library/crc.h"
+#include "library/framedecoder.h"
+#include "benchutil.h"
+
+namespace {
+
+constexpr qsizetype StreamBytes = 64 * 1024 * 1024; // Encoded bytes per case
+constexpr qsizetype FeedBytes = 4096;               // Typical readyRead chunk at high baud rates
+constexpr double BitsPerByte = 10.0;                 // Start + 8 data + stop
+constexpr int ColumnWidth = 14;
+
+QString megabytesPerSecond(qsizetype bytes, qint64 ns) {
+    return QString::number(bytes / 1e6 / (ns / 1e9), 'f', 1);
+}
+
+QString megabaud(qsizetype bytes, qint64 ns) {
+    return QString::number(bytes * BitsPerByte / 1e6 / (ns / 1e9), 'f', 1);
+}
+
+std::unique_ptr<FrameDecoder> makeDecoder(const QString &framing, FrameDecoder::Checksum checksum) {
+    if (framing == "cobs") {
+        return std::make_unique<CobsFrameDecoder>(checksum);
+    }
+    if (framing == "slip") {
+        return std::make_unique<SlipFrameDecoder>(checksum);
+    }
+    return std::make_unique<LengthPrefixedFrameDecoder>(2, checksum);
+}
+
+} // namespace
+
+void runDecoderBenchmarks(QTextStream &out, bool csv) {
+    printRow(out, csv, ColumnWidth, {"kernel", "checksum", "frame", "MBps", "Mbaud_8N1", "frames", "errors"});
+
+    // Raw checksum kernels over one large buffer
+    const QByteArray block = randomBytes(StreamBytes);
+    {
+        QElapsedTimer timer;
+        timer.start();
+        volatile quint16 crc = crc16Ccitt(block.constData(), block.size());
+        Q_UNUSED(crc);
+        const qint64 ns = timer.nsecsElapsed();
+        printRow(out, csv, ColumnWidth, {"crc", "crc16", "-", megabytesPerSecond(block.size(), ns),
+                                         megabaud(block.size(), ns), "-", "-"});
+    }
+    {
+        QElapsedTimer timer;
+        timer.start();
+        volatile quint32 crc = crc32(block.constData(), block.size());
+        Q_UNUSED(crc);
+        const qint64 ns = timer.nsecsElapsed();
+        printRow(out, csv, ColumnWidth, {"crc", "crc32", "-", megabytesPerSecond(block.size(), ns),
+                                         megabaud(block.size(), ns), "-", "-"});
+    }
+
+    const QStringList framings = {"cobs", "slip", "len16"};
+    const QList<QPair<QString, FrameDecoder::Checksum>> checksums = {
+        {"none", FrameDecoder::Checksum::None},
+        {"crc16", FrameDecoder::Checksum::Crc16},
+        {"crc32", FrameDecoder::Checksum::Crc32}};
+    const QList<qsizetype> frameSizes = {16, 256, 4096};
+
+    for (const QString &framing : framings) {
+        for (const auto &checksum : checksums) {
+            for (const qsizetype frameSize : frameSizes) {
+                std::unique_ptr<FrameDecoder> decoder = makeDecoder(framing, checksum.second);
+                quint64 payloadSum = 0;
+                decoder->setFrameHandler([&payloadSum](QByteArrayView frame) {
+                    payloadSum += quint64(frame.size());
+                });
+
+                // Encode a pool of frames once, then repeat it to the target stream size
+                QByteArray pool;
+                for (int i = 0; i < 64; ++i) {
+                    pool += decoder->encode(randomBytes(frameSize));
+                }
+                QByteArray stream;
+                stream.reserve(StreamBytes + pool.size());
+                while (stream.size() < StreamBytes) {
+                    stream += pool;
+                }
+
+                QElapsedTimer timer;
+                timer.start();
+                for (qsizetype offset = 0; offset < stream.size(); offset += FeedBytes) {
+                    decoder->feed(QByteArrayView(stream).sliced(offset, qMin(FeedBytes, stream.size() - offset)));
+                }
+                const qint64 ns = timer.nsecsElapsed();
+
+                const FrameDecoder::Stats stats = decoder->stats();
+                printRow(out, csv, ColumnWidth, {framing, checksum.first, QString::number(frameSize),
+                                                 megabytesPerSecond(stream.size(), ns), megabaud(stream.size(), ns),
+                                                 QString::number(stats.frames), QString::number(stats.errors())});
+            }
+        }
+    }
+}
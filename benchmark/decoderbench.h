@@ -0,0 +1,10 @@
+#ifndef DECODERBENCH_H
+#define DECODERBENCH_H
+
+#include <QTextStream>
+
+// Measures CRC kernels and each frame decoder on in-memory streams, fed in
+// readyRead-sized pieces, and reports the equivalent line rate at 8N1.
+void runDecoderBenchmarks(QTextStream &out, bool csv);
+
+#endif // DECODERBENCH_H
@@ -0,0 +1,345 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <ctime>
+#include <vector>
+#include "library/firmwareuart.h"
+#include "benchutil.h"
+#include "decoderbench.h"
+#include "matcherbench.h"
+#include "ptyloopback.h"
+#include "schedulebench.h"
+#include "sessionbench.h"
+#include "telemetrybench.h"
+#include "uploadbench.h"
+
+namespace {
+
+struct CaseResult {
+    double txMBps = 0.0;
+    double txCpuMsPerMB = 0.0;
+    double rxMBps = 0.0;
+    double rxCpuMsPerMB = 0.0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    bool ok = true;
+};
+
+constexpr int CaseTimeoutMs = 60000;
+constexpr int ColumnWidth = 17;
+constexpr qint64 PacedCaseSeconds = 3; // Payloads for --paced are capped at this much line time
+constexpr double PacedMinSeconds = 1.0; // Shorter --paced payloads are dominated by opening the port
+constexpr double PacedPassShare = 0.9;  // Share of the line rate a --paced case must reach
+
+// CPU time of the calling thread, which is where FirmwareUART runs in these benchmarks
+qint64 threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+bool openUart(FirmwareUART &uart, const PtyLoopback &pty, int baudRate, QTextStream &err) {
+    if (!uart.connectToPort(pty.slavePath(), baudRate)) {
+        err << "terminal-bench: could not open " << pty.slavePath() << Qt::endl;
+        return false;
+    }
+    return true;
+}
+
+// FirmwareUART sends the payload; the far end only counts what arrives, no faster than
+// linkRate bytes per second when that is set
+bool measureTransmit(int baudRate, int chunkSize, const QByteArray &payload, CaseResult &result, QTextStream &err,
+                     qint64 linkRate = 0) {
+    PtyLoopback pty;
+    QString error;
+    if (!pty.open(&error)) {
+        err << "terminal-bench: " << error << Qt::endl;
+        return false;
+    }
+    pty.setLinkRate(linkRate);
+    pty.startSink();
+
+    FirmwareUART uart;
+    uart.setChunkSize(chunkSize);
+    uart.setDataToSend(payload);
+
+    QElapsedTimer wall;
+    wall.start();
+    const qint64 cpuStart = threadCpuNs();
+    if (!openUart(uart, pty, baudRate, err)) {
+        return false;
+    }
+    const bool done = runUntil([&] { return pty.bytesRead() >= quint64(payload.size()); }, CaseTimeoutMs);
+    const qint64 cpuNs = threadCpuNs() - cpuStart;
+    const qint64 wallNs = wall.nsecsElapsed();
+    uart.disconnectFromPort();
+
+    const double megabytes = payload.size() / 1e6;
+    result.txMBps = megabytes / (wallNs / 1e9);
+    result.txCpuMsPerMB = (cpuNs / 1e6) / megabytes;
+    return done;
+}
+
+// The far end sends the payload; FirmwareUART receives it
+bool measureReceive(int baudRate, const QByteArray &payload, CaseResult &result, QTextStream &err) {
+    PtyLoopback pty;
+    QString error;
+    if (!pty.open(&error)) {
+        err << "terminal-bench: " << error << Qt::endl;
+        return false;
+    }
+
+    FirmwareUART uart;
+    qint64 received = 0;
+    QObject::connect(&uart, &FirmwareUART::dataReceived, [&received](const QByteArray &data) {
+        received += data.size();
+    });
+    if (!openUart(uart, pty, baudRate, err)) {
+        return false;
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+    const qint64 cpuStart = threadCpuNs();
+    pty.startSource(payload);
+    const bool done = runUntil([&] { return received >= payload.size(); }, CaseTimeoutMs);
+    const qint64 cpuNs = threadCpuNs() - cpuStart;
+    const qint64 wallNs = wall.nsecsElapsed();
+    uart.disconnectFromPort();
+
+    const double megabytes = payload.size() / 1e6;
+    result.rxMBps = megabytes / (wallNs / 1e9);
+    result.rxCpuMsPerMB = (cpuNs / 1e6) / megabytes;
+    return done;
+}
+
+// Round trip of one chunk-sized probe at a time through FirmwareUART, the pty and an echo
+bool measureEchoLatency(int baudRate, int chunkSize, int probes, CaseResult &result, QTextStream &err) {
+    PtyLoopback pty;
+    QString error;
+    if (!pty.open(&error)) {
+        err << "terminal-bench: " << error << Qt::endl;
+        return false;
+    }
+    pty.startEcho();
+
+    FirmwareUART uart;
+    uart.setChunkSize(chunkSize);
+    if (!openUart(uart, pty, baudRate, err)) {
+        return false;
+    }
+
+    const QByteArray probe = randomBytes(chunkSize);
+    uart.setDataToSend(probe);
+
+    std::vector<qint64> latenciesNs;
+    latenciesNs.reserve(size_t(probes));
+    QElapsedTimer probeTimer;
+    qint64 received = 0;
+    bool sent = false;
+
+    // The next probe goes out once the previous one is both fully written and fully echoed
+    auto sendNext = [&] {
+        if (int(latenciesNs.size()) >= probes) {
+            return;
+        }
+        received = 0;
+        sent = false;
+        probeTimer.start();
+        uart.sendData();
+    };
+    auto maybeFinish = [&] {
+        if (sent && received >= probe.size() && probeTimer.isValid()) {
+            latenciesNs.push_back(probeTimer.nsecsElapsed());
+            probeTimer.invalidate();
+            sendNext();
+        }
+    };
+    QObject::connect(&uart, &FirmwareUART::dataSent, [&] {
+        sent = true;
+        maybeFinish();
+    });
+    QObject::connect(&uart, &FirmwareUART::dataReceived, [&](const QByteArray &data) {
+        received += data.size();
+        maybeFinish();
+    });
+
+    sendNext();
+    const bool done = runUntil([&] { return int(latenciesNs.size()) >= probes; }, CaseTimeoutMs);
+    uart.disconnectFromPort();
+
+    if (latenciesNs.empty()) {
+        return false;
+    }
+    result.p50Us = percentile(latenciesNs, 50) / 1e3;
+    result.p99Us = percentile(latenciesNs, 99) / 1e3;
+    return done;
+}
+
+// Transmit over a pty that drains at each baud rate's line rate, 10 bits per byte at 8N1.
+// A transmit path that keeps the line busy reaches close to 100% of it; gaps between
+// chunks, such as waiting on each write in turn, show up as a lower share. Cases with at
+// least PacedMinSeconds of line time fail below PacedPassShare; shorter ones are not judged.
+bool runPacedTransmit(QTextStream &out, bool csv, const QList<qint64> &bauds, const QList<qint64> &chunks,
+                      const QList<qint64> &payloads) {
+    QTextStream err(stderr);
+    const QStringList columns = {"baud", "chunk", "payload", "line_MBps", "tx_MBps", "tx_pct_of_line",
+                                 "tx_cpu_ms_per_MB", "result"};
+    printRow(out, csv, ColumnWidth, columns);
+
+    bool allOk = true;
+    for (const qint64 baud : bauds) {
+        const qint64 lineRate = qMax<qint64>(1, baud / 10);
+        for (const qint64 chunk : chunks) {
+            for (const qint64 payloadSize : payloads) {
+                // Long enough to measure, short enough to finish well inside the case timeout
+                const qint64 size = qBound<qint64>(1, payloadSize, lineRate * PacedCaseSeconds);
+                const QByteArray payload = randomBytes(size);
+                CaseResult result;
+                result.ok = measureTransmit(int(baud), int(chunk), payload, result, err, lineRate);
+
+                const double lineMBps = lineRate / 1e6;
+                const bool judged = size >= lineRate * PacedMinSeconds;
+                const bool fast = !judged || result.txMBps >= PacedPassShare * lineMBps;
+                allOk = allOk && result.ok && fast;
+                const QString verdict = !result.ok ? "timed out" : !fast ? "slow" : judged ? "ok" : "too short";
+
+                const QStringList values = {
+                    QString::number(baud), QString::number(chunk), QString::number(size),
+                    QString::number(lineMBps, 'f', 4), QString::number(result.txMBps, 'f', 4),
+                    QString::number(100.0 * result.txMBps / lineMBps, 'f', 1),
+                    QString::number(result.txCpuMsPerMB, 'f', 2), verdict};
+                printRow(out, csv, ColumnWidth, values);
+            }
+        }
+    }
+    return allOk;
+}
+
+QList<qint64> parseList(const QString &value) {
+    QList<qint64> numbers;
+    for (const QString &item : value.split(',', Qt::SkipEmptyParts)) {
+        numbers << item.trimmed().toLongLong();
+    }
+    return numbers;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("terminal-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sweep the FirmwareUART I/O path over pseudo-terminal pairs.");
+    parser.addHelpOption();
+    const QCommandLineOption baudsOption("bauds", "Comma-separated baud rates.", "list", "115200,921600,3000000");
+    const QCommandLineOption chunksOption("chunks", "Comma-separated transmit chunk sizes.", "list", "32,256,4096");
+    const QCommandLineOption payloadsOption("payloads", "Comma-separated payload sizes in bytes.", "list", "65536,1048576");
+    const QCommandLineOption probesOption("probes", "Echo round trips per latency measurement.", "count", "200");
+    const QCommandLineOption csvOption("csv", "Print comma-separated values instead of a table.");
+    const QCommandLineOption decodersOption("decoders", "Benchmark CRC kernels and frame decoders instead.");
+    const QCommandLineOption portsOption("ports",
+        "Benchmark concurrent sessions instead, for each comma-separated port count.", "list");
+    const QCommandLineOption rateOption("rate", "Bytes per second each port receives with --ports or --schedule.",
+                                        "bytes", "11520");
+    const QCommandLineOption secondsOption("seconds", "Length of each --ports or --schedule case.", "seconds", "5");
+    const QCommandLineOption uploadOption("upload",
+        "Benchmark WindowedUpload instead, for each comma-separated window size.", "list");
+    const QCommandLineOption imageOption("image-bytes", "Image size for --upload.", "bytes", "1048576");
+    const QCommandLineOption latencyOption("latency-ms", "Delay before the --upload device replies.", "ms", "2");
+    const QCommandLineOption lossOption("loss", "Fraction of --upload blocks the device drops.", "fraction", "0");
+    const QCommandLineOption scheduleOption("schedule",
+        "Benchmark TransmitScheduler jitter instead, for each comma-separated count of busy ports.", "list");
+    const QCommandLineOption matchersOption("matchers",
+        "Benchmark the trigger engine instead, for each comma-separated pattern count.", "list");
+    const QCommandLineOption telemetryOption("telemetry",
+        "Benchmark telemetry parsing and plot decimation instead, for each comma-separated channel count.", "list");
+    const QCommandLineOption pacedOption("paced",
+        "Measure transmit against a far end that reads at each baud rate's line rate instead, "
+        "failing cases that reach less than 90% of it.");
+    parser.addOptions({baudsOption, chunksOption, payloadsOption, probesOption, csvOption, pacedOption,
+                       decodersOption, portsOption, rateOption, secondsOption, uploadOption, imageOption,
+                       latencyOption, lossOption, matchersOption, scheduleOption, telemetryOption});
+    parser.process(app);
+
+    if (parser.isSet(decodersOption)) {
+        QTextStream out(stdout);
+        runDecoderBenchmarks(out, parser.isSet(csvOption));
+        return 0;
+    }
+    if (parser.isSet(matchersOption)) {
+        QTextStream out(stdout);
+        runMatcherBenchmarks(out, parser.isSet(csvOption), parseList(parser.value(matchersOption)));
+        return 0;
+    }
+    if (parser.isSet(telemetryOption)) {
+        QTextStream out(stdout);
+        runTelemetryBenchmarks(out, parser.isSet(csvOption), parseList(parser.value(telemetryOption)));
+        return 0;
+    }
+    if (parser.isSet(uploadOption)) {
+        QTextStream out(stdout);
+        const bool ok = runUploadBenchmarks(out, parser.isSet(csvOption), parseList(parser.value(uploadOption)),
+                                            qMax<qint64>(4, parser.value(imageOption).toLongLong()),
+                                            parser.value(latencyOption).toInt(), parser.value(lossOption).toDouble());
+        return ok ? 0 : 1;
+    }
+    if (parser.isSet(scheduleOption)) {
+        QTextStream out(stdout);
+        const bool ok = runScheduleBenchmarks(out, parser.isSet(csvOption), parseList(parser.value(scheduleOption)),
+                                              parser.value(rateOption).toLongLong(),
+                                              qMax(1, parser.value(secondsOption).toInt()));
+        return ok ? 0 : 1;
+    }
+    if (parser.isSet(portsOption)) {
+        QTextStream out(stdout);
+        const bool ok = runSessionBenchmarks(out, parser.isSet(csvOption), parseList(parser.value(portsOption)),
+                                             parser.value(rateOption).toLongLong(),
+                                             qMax(1, parser.value(secondsOption).toInt()));
+        return ok ? 0 : 1;
+    }
+
+    const QList<qint64> bauds = parseList(parser.value(baudsOption));
+    const QList<qint64> chunks = parseList(parser.value(chunksOption));
+    const QList<qint64> payloads = parseList(parser.value(payloadsOption));
+    const int probes = qMax(1, parser.value(probesOption).toInt());
+    const bool csv = parser.isSet(csvOption);
+
+    QTextStream out(stdout);
+    if (parser.isSet(pacedOption)) {
+        return runPacedTransmit(out, csv, bauds, chunks, payloads) ? 0 : 1;
+    }
+
+    QTextStream err(stderr);
+    const QStringList columns = {"baud", "chunk", "payload", "tx_MBps", "tx_cpu_ms_per_MB",
+                                 "rx_MBps", "rx_cpu_ms_per_MB", "echo_p50_us", "echo_p99_us"};
+    printRow(out, csv, ColumnWidth, columns);
+
+    bool allOk = true;
+    for (const qint64 baud : bauds) {
+        for (const qint64 chunk : chunks) {
+            // Latency depends on the probe size, not on the payload, so measure it once per chunk
+            CaseResult latency;
+            latency.ok = measureEchoLatency(int(baud), int(chunk), probes, latency, err);
+
+            for (const qint64 payloadSize : payloads) {
+                const QByteArray payload = randomBytes(payloadSize);
+                CaseResult result = latency;
+                result.ok = latency.ok && measureTransmit(int(baud), int(chunk), payload, result, err)
+                            && measureReceive(int(baud), payload, result, err);
+                allOk = allOk && result.ok;
+
+                const QStringList values = {
+                    QString::number(baud), QString::number(chunk), QString::number(payloadSize),
+                    QString::number(result.txMBps, 'f', 2), QString::number(result.txCpuMsPerMB, 'f', 2),
+                    QString::number(result.rxMBps, 'f', 2), QString::number(result.rxCpuMsPerMB, 'f', 2),
+                    QString::number(result.p50Us, 'f', 1), QString::number(result.p99Us, 'f', 1)};
+                printRow(out, csv, ColumnWidth, values, result.ok ? "" : "  (timed out)");
+            }
+        }
+    }
+    return allOk ? 0 : 1;
+}
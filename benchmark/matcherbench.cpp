@@ -0,0 +1,106 @@
+#include "matcherbench.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include "library/triggerengine.h"
+#include "benchutil.h"
+
+namespace {
+
+constexpr qsizetype StreamBytes = 64 * 1024 * 1024; // Log text per case
+constexpr qsizetype FeedBytes = 4096;               // Typical readyRead chunk at high baud rates
+constexpr double BitsPerByte = 10.0;                 // Start + 8 data + stop
+constexpr int RegexTriggers = 8;
+constexpr int LinesPerPlantedMatch = 100;
+constexpr int ColumnWidth = 12;
+
+const char *const Words[] = {
+    "usb", "eth0", "link", "up", "down", "mmc0", "error", "timeout", "reset", "init", "done", "irq",
+    "dma", "probe", "failed", "ok", "voltage", "temp", "sensor", "boot", "kernel", "task", "heap", "stack",
+    "watchdog", "panic", "retry", "flash", "erase", "write", "read", "crc", "frame", "uart", "spi", "i2c"};
+constexpr int WordCount = int(sizeof(Words) / sizeof(Words[0]));
+
+const char *const Regexes[] = {
+    R"(ERR-\d{4})", R"(temp=\d{3}C)", R"(assert .* failed)", R"(^\[\s*\d+\.\d+\] oops)",
+    R"(stack overflow in \w+)", R"(rc=-\d+)", R"(0x[0-9a-f]{8} fault)", R"(brownout)"};
+
+// Trigger strings look like log text, so the automaton leaves its start state often
+QByteArray makePattern(QRandomGenerator &random) {
+    QByteArray pattern = Words[random.bounded(WordCount)];
+    pattern += random.bounded(2) ? ": " : " ";
+    pattern += Words[random.bounded(WordCount)];
+    pattern += ' ';
+    pattern += QByteArray::number(random.bounded(1000));
+    return pattern;
+}
+
+// Timestamped lines of random words, with one of the patterns planted every so often
+QByteArray makeLog(QRandomGenerator &random, const QList<QByteArray> &patterns) {
+    QByteArray log;
+    log.reserve(StreamBytes + 256);
+    for (int line = 0; log.size() < StreamBytes; ++line) {
+        log += '[' + QByteArray::number(line / 1000.0, 'f', 6) + "] ";
+        const int words = 4 + random.bounded(8);
+        for (int i = 0; i < words; ++i) {
+            log += Words[random.bounded(WordCount)];
+            log += (i + 1 < words) ? ' ' : ':';
+        }
+        if (line % LinesPerPlantedMatch == 0) {
+            log += ' ' + patterns[random.bounded(int(patterns.size()))];
+        }
+        log += "\r\n";
+    }
+    return log;
+}
+
+} // namespace
+
+void runMatcherBenchmarks(QTextStream &out, bool csv, const QList<qint64> &patternCounts) {
+    printRow(out, csv, ColumnWidth, {"patterns", "kind", "states", "MBps", "Gbps", "Mbaud_8N1", "matches"});
+
+    for (const qint64 count : patternCounts) {
+        QRandomGenerator random(quint32(count));
+        QList<QByteArray> patterns;
+        for (qint64 i = 0; i < qMax<qint64>(1, count); ++i) {
+            patterns << makePattern(random);
+        }
+        const QByteArray log = makeLog(random, patterns);
+
+        for (const QString &kind : {QString("exact"), QString("nocase"), QString("regex")}) {
+            TriggerEngine engine;
+            for (int i = 0; i < patterns.size(); ++i) {
+                TriggerEngine::Trigger trigger;
+                trigger.pattern = patterns[i];
+                trigger.ignoreCase = (kind == "nocase" && i % 4 == 0);
+                engine.addTrigger(trigger);
+            }
+            if (kind == "regex") {
+                for (const char *regex : Regexes) {
+                    TriggerEngine::Trigger trigger;
+                    trigger.pattern = regex;
+                    trigger.regex = true;
+                    engine.addTrigger(trigger);
+                }
+            }
+            engine.compile();
+
+            // Matches go nowhere; the handler only stands in for emitting the signal
+            quint64 offsets = 0;
+            engine.setMatchHandler([&offsets](int, qint64 offset, qint64) { offsets += quint64(offset); });
+
+            QElapsedTimer timer;
+            timer.start();
+            for (qsizetype offset = 0; offset < log.size(); offset += FeedBytes) {
+                engine.feed(QByteArrayView(log).sliced(offset, qMin(FeedBytes, log.size() - offset)), offset);
+            }
+            const qint64 ns = timer.nsecsElapsed();
+
+            const double seconds = ns / 1e9;
+            printRow(out, csv, ColumnWidth, {QString::number(patterns.size()), kind,
+                                             QString::number(engine.stateCount()),
+                                             QString::number(log.size() / 1e6 / seconds, 'f', 1),
+                                             QString::number(log.size() * 8 / 1e9 / seconds, 'f', 2),
+                                             QString::number(log.size() * BitsPerByte / 1e6 / seconds, 'f', 0),
+                                             QString::number(engine.totalMatches())});
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef MATCHERBENCH_H
+#define MATCHERBENCH_H
+
+#include <QList>
+#include <QTextStream>
+
+// Feeds a synthetic device log through TriggerEngine in readyRead-sized pieces for each
+// pattern count: exact literals, literals with a quarter ignoring case, and literals plus
+// a handful of regex triggers. Reports throughput against the line rate at 8N1.
+void runMatcherBenchmarks(QTextStream &out, bool csv, const QList<qint64> &patternCounts);
+
+#endif // MATCHERBENCH_H
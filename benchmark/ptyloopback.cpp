@@ -0,0 +1,196 @@
+#include "ptyloopback.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+PtyLoopback::PtyLoopback() : masterFd(-1), slaveFd(-1), paceRate(0), linkRate(0), responseLatencyMs(0), running(false), readCount(0), writeCount(0) {}
+
+PtyLoopback::~PtyLoopback() {
+    stop();
+    if (slaveFd >= 0) {
+        ::close(slaveFd);
+    }
+    if (masterFd >= 0) {
+        ::close(masterFd);
+    }
+}
+
+bool PtyLoopback::open(QString *error) {
+    masterFd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+        *error = QString("posix_openpt: %1").arg(strerror(errno));
+        return false;
+    }
+
+    slave = QString::fromLocal8Bit(ptsname(masterFd));
+    slaveFd = ::open(slave.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+    if (slaveFd < 0) {
+        *error = QString("%1: %2").arg(slave, strerror(errno));
+        return false;
+    }
+
+    // No echo or line discipline on either side; QSerialPort sets the same when it opens
+    termios attributes;
+    tcgetattr(slaveFd, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(slaveFd, TCSANOW, &attributes);
+    return true;
+}
+
+QString PtyLoopback::slavePath() const {
+    return slave;
+}
+
+void PtyLoopback::setLinkRate(qint64 bytesPerSecond) {
+    linkRate = qMax<qint64>(0, bytesPerSecond);
+}
+
+void PtyLoopback::startSink() {
+    start(Mode::Sink);
+}
+
+void PtyLoopback::startEcho() {
+    start(Mode::Echo);
+}
+
+void PtyLoopback::startSource(const QByteArray &data) {
+    sourceData = data;
+    start(Mode::Source);
+}
+
+void PtyLoopback::startPacedSource(qint64 bytesPerSecond) {
+    paceRate = bytesPerSecond;
+    start(Mode::PacedSource);
+}
+
+void PtyLoopback::startResponder(Responder respond, int latencyMs) {
+    responder = std::move(respond);
+    responseLatencyMs = qMax(0, latencyMs);
+    start(Mode::Responder);
+}
+
+void PtyLoopback::start(Mode mode) {
+    stop();
+    readCount = 0;
+    writeCount = 0;
+    running = true;
+    worker = std::thread([this, mode] { run(mode); });
+}
+
+void PtyLoopback::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+quint64 PtyLoopback::bytesRead() const {
+    return readCount.load();
+}
+
+quint64 PtyLoopback::bytesWritten() const {
+    return writeCount.load();
+}
+
+void PtyLoopback::run(Mode mode) {
+    if (mode == Mode::Source && !writeAll(sourceData.constData(), sourceData.size())) {
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    // Paced mode tops the output up to rate * elapsed every few milliseconds, the way a
+    // device streaming telemetry would, so many ports can run side by side at a known load
+    const Clock::time_point paceStart = Clock::now();
+    const QByteArray pattern(4096, 'U');
+
+    // Responder replies wait here until their simulated latency has passed
+    std::deque<std::pair<Clock::time_point, QByteArray>> replies;
+
+    // With a link rate, each read occupies the line for its bytes' transmission time and the
+    // next waits until the line is free; the writer meanwhile backs up into the pty buffer
+    Clock::time_point lineFree = Clock::now();
+    const qsizetype sliceBytes = linkRate > 0 ? qBound<qsizetype>(1, linkRate * LinkSliceMs / 1000, 64 * 1024)
+                                              : 64 * 1024;
+
+    char buffer[64 * 1024];
+    while (running) {
+        while (!replies.empty() && replies.front().first <= Clock::now()) {
+            if (!writeAll(replies.front().second.constData(), replies.front().second.size())) {
+                return;
+            }
+            replies.pop_front();
+        }
+        int timeoutMs = (mode == Mode::PacedSource) ? 5 : 20;
+        if (!replies.empty()) {
+            const auto wait = std::chrono::ceil<std::chrono::milliseconds>(replies.front().first - Clock::now());
+            timeoutMs = qBound(0, int(wait.count()), timeoutMs);
+        }
+
+        if (mode == Mode::PacedSource) {
+            const double elapsed = std::chrono::duration<double>(Clock::now() - paceStart).count();
+            const qint64 due = qint64(elapsed * paceRate) - qint64(writeCount.load());
+            if (due > 0 && !writeAll(pattern.constData(), qMin(due, pattern.size()))) {
+                return;
+            }
+        }
+
+        if (linkRate > 0 && Clock::now() < lineFree) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(lineFree - Clock::now(),
+                                                                  std::chrono::milliseconds(timeoutMs)));
+            continue;
+        }
+
+        pollfd fd = {masterFd, POLLIN, 0};
+        if (poll(&fd, 1, timeoutMs) <= 0) {
+            continue;
+        }
+        const ssize_t length = ::read(masterFd, buffer, size_t(sliceBytes));
+        if (length <= 0) {
+            continue;
+        }
+        readCount += quint64(length);
+        if (linkRate > 0) {
+            lineFree = std::max(lineFree, Clock::now()) + std::chrono::nanoseconds(length * 1000000000LL / linkRate);
+        }
+        if (mode == Mode::Echo && !writeAll(buffer, length)) {
+            return;
+        }
+        if (mode == Mode::Responder) {
+            const QByteArray reply = responder(QByteArrayView(buffer, length));
+            if (reply.isEmpty()) {
+                continue;
+            }
+            if (responseLatencyMs == 0) {
+                if (!writeAll(reply.constData(), reply.size())) {
+                    return;
+                }
+            } else {
+                replies.emplace_back(Clock::now() + std::chrono::milliseconds(responseLatencyMs), reply);
+            }
+        }
+    }
+}
+
+bool PtyLoopback::writeAll(const char *data, qsizetype length) {
+    while (length > 0 && running) {
+        const ssize_t written = ::write(masterFd, data, size_t(length));
+        if (written > 0) {
+            writeCount += quint64(written);
+            data += written;
+            length -= written;
+        } else if (written < 0 && errno != EAGAIN && errno != EINTR) {
+            return false;
+        } else {
+            pollfd fd = {masterFd, POLLOUT, 0};
+            poll(&fd, 1, 20);
+        }
+    }
+    return length == 0;
+}
@@ -0,0 +1,64 @@
+#ifndef PTYLOOPBACK_H
+#define PTYLOOPBACK_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// The PtyLoopback class stands in for a device on the far end of a serial line.
+// It creates a pseudo-terminal pair; FirmwareUART opens slavePath() like a real port
+// while a background thread services the master side in one of five modes.
+// A pty moves bytes as fast as the kernel allows, whatever baud rate is configured,
+// so results measure the software path rather than the line rate, unless setLinkRate()
+// makes the far end read no faster than a serial line would deliver.
+class PtyLoopback
+{
+public:
+    PtyLoopback();
+    ~PtyLoopback();
+
+    bool open(QString *error);
+    QString slavePath() const;
+    void setLinkRate(qint64 bytesPerSecond);   // 0 reads as fast as possible; set before start
+
+    void startSink();                          // Read and discard, counting bytes
+    void startEcho();                          // Write back everything read
+    void startSource(const QByteArray &data);  // Write data once, then discard input
+    void startPacedSource(qint64 bytesPerSecond); // Write steadily at a fixed rate, discard input
+
+    // Pass everything read to respond() and write back what it returns, latencyMs later.
+    // respond() runs on the loopback's thread.
+    using Responder = std::function<QByteArray(QByteArrayView data)>;
+    void startResponder(Responder respond, int latencyMs = 0);
+    void stop();
+
+    quint64 bytesRead() const;                 // Bytes read from the master side so far
+    quint64 bytesWritten() const;              // Bytes written to the master side so far
+
+private:
+    enum class Mode { Sink, Echo, Source, PacedSource, Responder };
+
+    void start(Mode mode);
+    void run(Mode mode);
+    bool writeAll(const char *data, qsizetype length);
+
+    int masterFd;
+    int slaveFd;          // Held open so the master never sees a hang-up between sessions
+    QString slave;
+    QByteArray sourceData;
+    qint64 paceRate;
+    qint64 linkRate;
+    Responder responder;
+    int responseLatencyMs;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<quint64> readCount;
+    std::atomic<quint64> writeCount;
+
+    static constexpr qint64 LinkSliceMs = 2; // With a link rate, each read takes this much line time
+};
+
+#endif // PTYLOOPBACK_H
@@ -0,0 +1,95 @@
+#include "schedulebench.h"
+#include <memory>
+#include <vector>
+#include "library/sessionmanager.h"
+#include "library/transmitscheduler.h"
+#include "benchutil.h"
+#include "ptyloopback.h"
+
+namespace {
+
+constexpr qint64 Millisecond = 1000000;
+constexpr int ColumnWidth = 12;
+
+QString microseconds(qint64 ns) {
+    return QString::number(ns / 1e3, 'f', 1);
+}
+
+} // namespace
+
+bool runScheduleBenchmarks(QTextStream &out, bool csv, const QList<qint64> &loadPortCounts,
+                           qint64 bytesPerSecond, int seconds) {
+    QTextStream err(stderr);
+    printRow(out, csv, ColumnWidth, {"load_ports", "entry", "period_us", "sent", "missed", "skipped",
+                                     "late_mean_us", "late_p99_us", "late_max_us"});
+
+    bool allOk = true;
+    for (const qint64 loadPorts : loadPortCounts) {
+        // One I/O thread, so the scheduler competes with every busy port for it
+        SessionManager sessions(1);
+        std::vector<std::unique_ptr<PtyLoopback>> ptys;
+        QList<int> ids;
+        bool opened = true;
+        for (qint64 i = 0; i <= loadPorts && opened; ++i) {
+            auto pty = std::make_unique<PtyLoopback>();
+            QString error;
+            opened = pty->open(&error);
+            if (!opened) {
+                err << "terminal-bench: " << error << Qt::endl;
+                break;
+            }
+            const int id = sessions.addSession(new FirmwareUART);
+            opened = sessions.connectSession(id, pty->slavePath(), 115200);
+            if (!opened) {
+                err << "terminal-bench: could not open " << pty->slavePath() << Qt::endl;
+            }
+            ids << id;
+            ptys.push_back(std::move(pty));
+        }
+        if (!opened) {
+            allOk = false;
+            continue;
+        }
+
+        // The first session sends the timetable to a sink; the rest receive the load
+        FirmwareUART *uart = sessions.session(ids.first());
+        TransmitScheduler *scheduler = nullptr;
+        QMetaObject::invokeMethod(uart, [&] {
+            scheduler = new TransmitScheduler(uart);
+            scheduler->setTarget(uart);
+            scheduler->addPeriodic(QByteArray(8, 'C'), 1 * Millisecond);
+            scheduler->addPeriodic(QByteArray(16, 'A'), 10 * Millisecond);
+            scheduler->addPeriodic(QByteArray(64, 'B'), 250 * Millisecond);
+            scheduler->addOneShot(QByteArray(32, 'D'), seconds * 1000 * Millisecond / 2);
+        }, Qt::BlockingQueuedConnection);
+        ptys.front()->startSink();
+        for (size_t i = 1; i < ptys.size(); ++i) {
+            ptys[i]->startPacedSource(bytesPerSecond);
+        }
+
+        QMetaObject::invokeMethod(scheduler, [scheduler] { scheduler->start(); }, Qt::BlockingQueuedConnection);
+        runFor(seconds * 1000);
+        QMetaObject::invokeMethod(scheduler, &TransmitScheduler::stop, Qt::BlockingQueuedConnection);
+        for (const auto &pty : ptys) {
+            pty->stop();
+        }
+
+        const QList<qint64> periods = {1 * Millisecond, 10 * Millisecond, 250 * Millisecond, 0};
+        for (int entry = 0; entry < scheduler->entryCount(); ++entry) {
+            const qint64 p99 = scheduler->latenessPercentile(entry, 99);
+            const TransmitScheduler::EntryStats stats = scheduler->entryStats(entry);
+            allOk = allOk && stats.sent > 0;
+            printRow(out, csv, ColumnWidth, {QString::number(loadPorts), QString::number(entry),
+                                             QString::number(periods[entry] / 1000), QString::number(stats.sent),
+                                             QString::number(stats.missed()), QString::number(stats.skipped),
+                                             microseconds(stats.meanLatenessNs()), microseconds(p99),
+                                             microseconds(stats.maxLatenessNs)});
+        }
+
+        for (const int id : std::as_const(ids)) {
+            sessions.disconnectSession(id);
+        }
+        sessions.shutdown();
+    }
+    return allOk;
+}
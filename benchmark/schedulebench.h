@@ -0,0 +1,13 @@
+#ifndef SCHEDULEBENCH_H
+#define SCHEDULEBENCH_H
+
+#include <QList>
+#include <QTextStream>
+
+// Runs a TransmitScheduler timetable (1 ms, 10 ms and 250 ms periods plus a one-shot)
+// into a pty sink while other sessions on the same single I/O thread receive data at
+// bytesPerSecond each, and reports send lateness per entry for each count of busy ports.
+bool runScheduleBenchmarks(QTextStream &out, bool csv, const QList<qint64> &loadPortCounts,
+                           qint64 bytesPerSecond, int seconds);
+
+#endif // SCHEDULEBENCH_H
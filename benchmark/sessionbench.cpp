@@ -0,0 +1,110 @@
+#include "sessionbench.h"
+#include <QElapsedTimer>
+#include <QSet>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "library/sessionmanager.h"
+#include "benchutil.h"
+#include "ptyloopback.h"
+
+namespace {
+
+constexpr int ColumnWidth = 17;
+constexpr int DrainMs = 300; // Time allowed for bytes still in the ptys after the sources stop
+
+qint64 threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// CPU time used so far by each I/O thread that hosts one of the sessions. The far-end pty
+// threads are deliberately left out: they stand in for hardware.
+qint64 ioThreadsCpuNs(const SessionManager &sessions) {
+    QSet<QThread *> seen;
+    qint64 total = 0;
+    for (const int id : sessions.sessionIds()) {
+        FirmwareUART *uart = sessions.session(id);
+        if (seen.contains(uart->thread())) {
+            continue;
+        }
+        seen.insert(uart->thread());
+        qint64 cpuNs = 0;
+        QMetaObject::invokeMethod(uart, [&cpuNs] { cpuNs = threadCpuNs(); }, Qt::BlockingQueuedConnection);
+        total += cpuNs;
+    }
+    return total;
+}
+
+} // namespace
+
+bool runSessionBenchmarks(QTextStream &out, bool csv, const QList<qint64> &portCounts,
+                          qint64 bytesPerSecond, int seconds) {
+    QTextStream err(stderr);
+    printRow(out, csv, ColumnWidth, {"ports", "io_threads", "rx_Bps_per_port", "io_cpu_pct", "cpu_ms_per_s_port",
+                                     "rx_expected", "rx_bytes", "lost_bytes"});
+
+    bool allOk = true;
+    for (const qint64 portCount : portCounts) {
+        std::vector<std::unique_ptr<PtyLoopback>> ptys;
+        SessionManager sessions;
+        QList<int> ids;
+        bool opened = true;
+        for (qint64 i = 0; i < portCount && opened; ++i) {
+            auto pty = std::make_unique<PtyLoopback>();
+            QString error;
+            if (!pty->open(&error)) {
+                err << "terminal-bench: " << error << Qt::endl;
+                opened = false;
+                break;
+            }
+            const int id = sessions.addSession(new FirmwareUART);
+            if (!sessions.connectSession(id, pty->slavePath(), 115200)) {
+                err << "terminal-bench: could not open " << pty->slavePath() << Qt::endl;
+                opened = false;
+            }
+            ids << id;
+            ptys.push_back(std::move(pty));
+        }
+        if (!opened) {
+            allOk = false;
+            continue;
+        }
+
+        QElapsedTimer wall;
+        wall.start();
+        const qint64 cpuStart = ioThreadsCpuNs(sessions);
+        for (const auto &pty : ptys) {
+            pty->startPacedSource(bytesPerSecond);
+        }
+        runFor(seconds * 1000);
+        for (const auto &pty : ptys) {
+            pty->stop();
+        }
+        runFor(DrainMs);
+        const qint64 cpuNs = ioThreadsCpuNs(sessions) - cpuStart;
+        const qint64 wallNs = wall.nsecsElapsed();
+
+        quint64 expected = 0;
+        for (const auto &pty : ptys) {
+            expected += pty->bytesWritten();
+        }
+        const quint64 received = sessions.aggregateStats().receive.totalBytes;
+        const quint64 lost = expected > received ? expected - received : 0;
+        allOk = allOk && lost == 0;
+
+        const double cpuPercent = 100.0 * cpuNs / wallNs;
+        const double cpuMsPerSecondPerPort = (cpuNs / 1e6) / (wallNs / 1e9) / portCount;
+        printRow(out, csv, ColumnWidth, {QString::number(portCount), QString::number(sessions.ioThreadCount()),
+                                         QString::number(bytesPerSecond), QString::number(cpuPercent, 'f', 1),
+                                         QString::number(cpuMsPerSecondPerPort, 'f', 2), QString::number(expected),
+                                         QString::number(received), QString::number(lost)});
+
+        for (const int id : std::as_const(ids)) {
+            sessions.disconnectSession(id);
+        }
+        sessions.shutdown();
+    }
+    return allOk;
+}
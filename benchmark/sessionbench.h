@@ -0,0 +1,12 @@
+#ifndef SESSIONBENCH_H
+#define SESSIONBENCH_H
+
+#include <QList>
+#include <QTextStream>
+
+// Opens 1..N pty ports at once through SessionManager, each fed by a device streaming
+// at a fixed rate, and reports I/O thread CPU per port and whether any bytes went missing.
+bool runSessionBenchmarks(QTextStream &out, bool csv, const QList<qint64> &portCounts,
+                          qint64 bytesPerSecond, int seconds);
+
+#endif // SESSIONBENCH_H
@@ -0,0 +1,84 @@
+#include "telemetrybench.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <cmath>
+#include <vector>
+#include "library/telemetryparser.h"
+#include "benchutil.h"
+
+namespace {
+
+constexpr qint64 SampleRateHz = 1000;
+constexpr qint64 SimulatedSeconds = 3600;
+constexpr int LinesPerFeed = 10;        // A readyRead every 10 ms
+constexpr int DistinctLines = 4096;     // Pre-formatted lines, cycled through
+constexpr int PlotColumns = 1920;
+constexpr int RedrawRepeats = 50;
+constexpr int ColumnWidth = 12;
+
+// Lines such as "ch0=12.345 ch1=-0.52 ...", slow sine waves with a little noise
+QList<QByteArray> makeLines(int channels) {
+    QRandomGenerator random(quint32(channels));
+    QList<QByteArray> lines;
+    for (int line = 0; line < DistinctLines; ++line) {
+        QByteArray text;
+        for (int channel = 0; channel < channels; ++channel) {
+            const double value = 100.0 * std::sin(line * 0.01 + channel) + random.bounded(1.0);
+            text += "ch" + QByteArray::number(channel) + '=' + QByteArray::number(value, 'f', 3);
+            text += (channel + 1 < channels) ? ' ' : '\n';
+        }
+        lines << text;
+    }
+    return lines;
+}
+
+// Microseconds to decimate every channel over the last spanNs
+double redrawUs(const TelemetryStore &store, qint64 spanNs) {
+    std::vector<TelemetryStore::Column> columns(PlotColumns);
+    const qint64 toNs = store.lastTimeNs() + 1;
+    QElapsedTimer timer;
+    timer.start();
+    for (int repeat = 0; repeat < RedrawRepeats; ++repeat) {
+        for (int channel = 0; channel < store.channelCount(); ++channel) {
+            store.decimate(channel, toNs - spanNs, toNs, columns.data(), PlotColumns);
+        }
+    }
+    return timer.nsecsElapsed() / 1e3 / RedrawRepeats;
+}
+
+} // namespace
+
+void runTelemetryBenchmarks(QTextStream &out, bool csv, const QList<qint64> &channelCounts) {
+    printRow(out, csv, ColumnWidth, {"channels", "MBps", "Msamples_s", "cpu_pct_1kHz", "draw_1s_us", "draw_1min_us",
+                                     "draw_1h_us"});
+
+    for (const qint64 count : channelCounts) {
+        const int channels = int(qBound<qint64>(1, count, TelemetryStore::MaxChannels));
+        const QList<QByteArray> lines = makeLines(channels);
+        TelemetryStore store;
+        TelemetryParser parser(&store);
+
+        QByteArray feed;
+        feed.reserve(LinesPerFeed * lines.first().size() * 2);
+        qint64 bytes = 0;
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 totalLines = SampleRateHz * SimulatedSeconds;
+        for (qint64 line = 0; line < totalLines; line += LinesPerFeed) {
+            feed.clear();
+            for (int i = 0; i < LinesPerFeed; ++i) {
+                feed += lines[int((line + i) % DistinctLines)];
+            }
+            parser.feed(feed, (line + LinesPerFeed) * 1000000000 / SampleRateHz);
+            bytes += feed.size();
+        }
+        const double seconds = timer.nsecsElapsed() / 1e9;
+
+        printRow(out, csv, ColumnWidth, {QString::number(channels), QString::number(bytes / 1e6 / seconds, 'f', 1),
+                                         QString::number(parser.sampleCount() / 1e6 / seconds, 'f', 2),
+                                         QString::number(100.0 * seconds / SimulatedSeconds, 'f', 3),
+                                         QString::number(redrawUs(store, 1000000000LL), 'f', 1),
+                                         QString::number(redrawUs(store, 60LL * 1000000000), 'f', 1),
+                                         QString::number(redrawUs(store, SimulatedSeconds * 1000000000), 'f', 1)});
+    }
+}
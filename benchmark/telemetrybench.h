@@ -0,0 +1,13 @@
+#ifndef TELEMETRYBENCH_H
+#define TELEMETRYBENCH_H
+
+#include <QList>
+#include <QTextStream>
+
+// Feeds an hour of key=value telemetry at 1 kHz through TelemetryParser, for each channel
+// count, in readyRead-sized pieces stamped with simulated arrival times. Reports parse
+// throughput, the share of one core the parser would take at 1 kHz, and the time to
+// decimate every channel for a full-HD-wide plot over a second, a minute and the whole hour.
+void runTelemetryBenchmarks(QTextStream &out, bool csv, const QList<qint64> &channelCounts);
+
+#endif // TELEMETRYBENCH_H
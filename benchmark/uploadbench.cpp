@@ -0,0 +1,167 @@
+#include "uploadbench.h"
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <memory>
+#include "library/windowedupload.h"
+#include "benchutil.h"
+#include "ptyloopback.h"
+#include "uploaddevice.h"
+
+namespace {
+
+constexpr int CaseTimeoutMs = 120000;
+constexpr int ChunkBytes = 4096;
+constexpr int ColumnWidth = 14;
+constexpr qint64 PacedLinkBytesPerSecond = 11520; // 115200 baud at 8N1
+constexpr qint64 PacedImageBytes = 128 * 1024;    // About 11 s of line time
+constexpr double PacedLossRate = 0.01;
+
+// Plain sendFile() into a sink: the ceiling any protocol can reach on this path
+bool measureStream(const QString &imagePath, qint64 imageBytes, double &mbps, QTextStream &err) {
+    PtyLoopback pty;
+    QString error;
+    if (!pty.open(&error)) {
+        err << "terminal-bench: " << error << Qt::endl;
+        return false;
+    }
+    pty.startSink();
+
+    FirmwareUART uart;
+    uart.setChunkSize(ChunkBytes);
+    if (!uart.connectToPort(pty.slavePath(), 115200)) {
+        err << "terminal-bench: could not open " << pty.slavePath() << Qt::endl;
+        return false;
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+    const bool done = uart.sendFile(imagePath) &&
+                      runUntil([&] { return pty.bytesRead() >= quint64(imageBytes); }, CaseTimeoutMs);
+    mbps = imageBytes / 1e6 / (wall.nsecsElapsed() / 1e9);
+    uart.disconnectFromPort();
+    return done;
+}
+
+struct UploadResult {
+    bool finished = false;
+    bool ok = false;
+    QString failure;
+    double mbps = 0.0;
+    quint64 retransmits = 0;
+    int blockBytes = 0;
+};
+
+// One upload to an UploadDevice on a pty. With a link rate the device reads no faster than
+// the line would carry the bytes, and the upload runs with its own default timeout and retry
+// limits, as it would against real hardware.
+bool runUpload(const QString &imagePath, qint64 imageBytes, int window, int latencyMs, double lossRate,
+               qint64 linkBytesPerSecond, UploadResult &result, QTextStream &err) {
+    PtyLoopback pty;
+    QString error;
+    if (!pty.open(&error)) {
+        err << "terminal-bench: " << error << Qt::endl;
+        return false;
+    }
+    auto device = std::make_shared<UploadDevice>(lossRate);
+    pty.setLinkRate(linkBytesPerSecond);
+    pty.startResponder([device](QByteArrayView data) { return device->feed(data); }, latencyMs);
+
+    FirmwareUART uart;
+    uart.setChunkSize(ChunkBytes);
+    if (!uart.connectToPort(pty.slavePath(), 115200)) {
+        err << "terminal-bench: could not open " << pty.slavePath() << Qt::endl;
+        return false;
+    }
+
+    WindowedUpload upload;
+    upload.setTarget(&uart);
+    upload.setWindow(window);
+    if (linkBytesPerSecond == 0) {
+        upload.setTimeout(qMax(200, latencyMs * 20));
+        upload.setMaxRetries(50);
+    }
+    QObject::connect(&upload, &WindowedUpload::finished, [&](bool success, const QString &message) {
+        result.finished = true;
+        result.ok = success;
+        result.failure = message;
+    });
+
+    QElapsedTimer wall;
+    wall.start();
+    if (upload.start(imagePath)) {
+        runUntil([&] { return result.finished; }, CaseTimeoutMs);
+    }
+    const qint64 wallNs = wall.nsecsElapsed();
+    upload.cancel();
+    uart.disconnectFromPort();
+    pty.stop();
+
+    // The device's own verdict, read once its thread has stopped
+    result.ok = result.ok && device->imageOk();
+    result.mbps = imageBytes / 1e6 / (wallNs / 1e9);
+    result.retransmits = upload.retransmittedBlocks();
+    result.blockBytes = upload.blockSize();
+    return true;
+}
+
+QString verdict(const UploadResult &result) {
+    return result.ok ? QString("ok") : (result.finished ? result.failure : QString("timed out"));
+}
+
+} // namespace
+
+bool runUploadBenchmarks(QTextStream &out, bool csv, const QList<qint64> &windows, qint64 imageBytes,
+                         int latencyMs, double lossRate) {
+    QTextStream err(stderr);
+
+    QTemporaryFile imageFile;
+    if (!imageFile.open()) {
+        err << "terminal-bench: cannot create a temporary image" << Qt::endl;
+        return false;
+    }
+    const QByteArray image = randomBytes(imageBytes);
+    imageFile.write(image);
+    imageFile.flush();
+
+    printRow(out, csv, ColumnWidth, {"window", "block", "latency_ms", "loss", "MBps", "retransmits", "result"});
+
+    double streamMBps = 0.0;
+    const bool streamOk = measureStream(imageFile.fileName(), imageBytes, streamMBps, err);
+    printRow(out, csv, ColumnWidth, {"stream", "-", "-", "-", QString::number(streamMBps, 'f', 2), "-",
+                                     streamOk ? "ok" : "timed out"});
+
+    bool allOk = streamOk;
+    for (const qint64 window : windows) {
+        UploadResult result;
+        if (!runUpload(imageFile.fileName(), imageBytes, int(window), latencyMs, lossRate, 0, result, err)) {
+            return false;
+        }
+        allOk = allOk && result.ok;
+        printRow(out, csv, ColumnWidth, {QString::number(window), QString::number(result.blockBytes),
+                                         QString::number(latencyMs), QString::number(lossRate),
+                                         QString::number(result.mbps, 'f', 2), QString::number(result.retransmits),
+                                         verdict(result)});
+    }
+
+    // A slow line with some loss, at the upload's defaults: resent blocks must not queue
+    // behind a window of stale ones, or the defaults give up before the device sees them
+    QTemporaryFile pacedFile;
+    if (!pacedFile.open()) {
+        err << "terminal-bench: cannot create a temporary image" << Qt::endl;
+        return false;
+    }
+    pacedFile.write(image.left(qMin(imageBytes, PacedImageBytes)));
+    pacedFile.flush();
+    const double pacedLoss = qMax(lossRate, PacedLossRate);
+    UploadResult paced;
+    if (!runUpload(pacedFile.fileName(), pacedFile.size(), WindowedUpload().window(), latencyMs, pacedLoss,
+                   PacedLinkBytesPerSecond, paced, err)) {
+        return false;
+    }
+    allOk = allOk && paced.ok;
+    printRow(out, csv, ColumnWidth, {QString("paced %1").arg(PacedLinkBytesPerSecond * 10),
+                                     QString::number(paced.blockBytes), QString::number(latencyMs),
+                                     QString::number(pacedLoss), QString::number(paced.mbps, 'f', 2),
+                                     QString::number(paced.retransmits), verdict(paced)});
+    return allOk;
+}
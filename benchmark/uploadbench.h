@@ -0,0 +1,14 @@
+#ifndef UPLOADBENCH_H
+#define UPLOADBENCH_H
+
+#include <QList>
+#include <QTextStream>
+
+// Uploads a random image to an UploadDevice on a pty for each window size, with the
+// device's replies delayed by latencyMs to stand in for flash writes and line turnaround,
+// and compares against streaming the same file with no protocol at all. A last case runs
+// the default window, timeout and retry limit over a pty paced at 115200 baud with 1% loss.
+bool runUploadBenchmarks(QTextStream &out, bool csv, const QList<qint64> &windows, qint64 imageBytes,
+                         int latencyMs, double lossRate);
+
+#endif // UPLOADBENCH_H
@@ -0,0 +1,67 @@
+#include "uploaddevice.h"
+#include <QtEndian>
+#include "library/crc.h"
+
+UploadDevice::UploadDevice(double lossRate)
+    : decoder(FrameDecoder::Checksum::Crc32), random(1), loss(lossRate), blockBytes(0), expectedBytes(0),
+      expectedCrc(0), nextBlock(0), receivedBytes(0), receivedCrc(0), nakSent(false), ok(false) {
+    decoder.setFrameHandler([this](QByteArrayView message) { handleMessage(message); });
+}
+
+QByteArray UploadDevice::feed(QByteArrayView data) {
+    replies.clear();
+    decoder.feed(data);
+    return replies;
+}
+
+bool UploadDevice::imageOk() const {
+    return ok;
+}
+
+void UploadDevice::handleMessage(QByteArrayView message) {
+    if (message.size() < 5) {
+        return;
+    }
+    const quint8 type = quint8(message[0]);
+    const quint32 value = qFromLittleEndian<quint32>(message.data() + 1);
+
+    if (type == 0x01 && message.size() >= 17) { // START
+        blockBytes = value;
+        expectedBytes = qFromLittleEndian<quint64>(message.data() + 5);
+        expectedCrc = qFromLittleEndian<quint32>(message.data() + 13);
+        nextBlock = 0;
+        receivedBytes = 0;
+        receivedCrc = 0;
+        nakSent = false;
+        ok = false;
+        reply(0x81, 0);
+    } else if (type == 0x02) { // DATA
+        if (loss > 0.0 && random.generateDouble() < loss) {
+            return; // As if the frame had been corrupted on the line
+        }
+        if (value == nextBlock) {
+            const QByteArrayView block = message.sliced(5);
+            receivedCrc = crc32(block.data(), block.size(), receivedCrc);
+            receivedBytes += quint64(block.size());
+            ++nextBlock;
+            nakSent = false;
+            reply(0x81, nextBlock);
+        } else if (value > nextBlock && !nakSent) {
+            nakSent = true;
+            reply(0x82, nextBlock);
+        }
+    } else if (type == 0x03) { // END
+        ok = value == nextBlock && receivedBytes == expectedBytes && receivedCrc == expectedCrc;
+        QByteArray done(2, Qt::Uninitialized);
+        done[0] = char(0x83);
+        done[1] = char(ok ? 0 : 1);
+        replies += decoder.encode(done);
+    }
+}
+
+void UploadDevice::reply(quint8 type, quint32 value) {
+    QByteArray message(5, Qt::Uninitialized);
+    message[0] = char(type);
+    qToLittleEndian<quint32>(value, message.data() + 1);
+    replies += decoder.encode(message);
+}
@@ -0,0 +1,39 @@
+#ifndef UPLOADDEVICE_H
+#define UPLOADDEVICE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QRandomGenerator>
+#include "library/framedecoder.h"
+
+// The UploadDevice class is the device end of WindowedUpload, the way a bootloader would
+// implement it: in-order blocks only, a cumulative ACK for each, one NAK per gap, and a
+// CRC-32 check of the whole image at the end. It can drop a fraction of the blocks it
+// receives to exercise retransmission. Not thread-safe; it lives on the pty thread.
+class UploadDevice
+{
+public:
+    explicit UploadDevice(double lossRate = 0.0);
+
+    QByteArray feed(QByteArrayView data); // Returns the encoded replies, if any
+    bool imageOk() const;                 // The last upload ended with a matching CRC
+
+private:
+    void handleMessage(QByteArrayView message);
+    void reply(quint8 type, quint32 value);
+
+    CobsFrameDecoder decoder;
+    QByteArray replies;
+    QRandomGenerator random;
+    double loss;
+    quint32 blockBytes;
+    quint64 expectedBytes;
+    quint32 expectedCrc;
+    quint32 nextBlock;
+    quint64 receivedBytes;
+    quint32 receivedCrc;
+    bool nakSent;         // Already asked for nextBlock since the gap appeared
+    bool ok;
+};
+
+#endif // UPLOADDEVICE_H
@@ -0,0 +1,18 @@
+# Headless front end for FirmwareUART: connect, send a file, capture to a file, print stats.
+QT       -= gui
+QT       += core serialport
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = terminal-cli
+
+include(../library/library.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
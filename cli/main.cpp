@@ -0,0 +1,528 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QTextStream>
+#include <QTimer>
+#include <memory>
+#include <vector>
+#include "library/replayengine.h"
+#include "library/sessionmanager.h"
+#include "library/telemetryparser.h"
+#include "library/transmitscheduler.h"
+#include "library/triggerengine.h"
+#include "library/windowedupload.h"
+
+// Prints one line of statistics; the format is stable so scripts can parse it
+static void printStats(const QString &port, const SerialMetrics::Snapshot &stats, quint64 logWritten,
+                       const FrameDecoder *decoder, const TriggerEngine *triggers) {
+    QTextStream out(stdout);
+    out << QString("port=%1 elapsed_ms=%2 tx_bytes=%3 tx_bps=%4 rx_bytes=%5 rx_bps=%6 errors=%7 overruns=%8 "
+                   "dropped=%9 log_written=%10 log_dropped=%11")
+               .arg(port)
+               .arg(stats.elapsedNs / 1000000)
+               .arg(stats.transmit.totalBytes)
+               .arg(stats.transmit.windowBps, 0, 'f', 0)
+               .arg(stats.receive.totalBytes)
+               .arg(stats.receive.windowBps, 0, 'f', 0)
+               .arg(stats.errors)
+               .arg(stats.overruns)
+               .arg(stats.droppedBytes)
+               .arg(logWritten)
+               .arg(stats.logDroppedBytes);
+    if (decoder) {
+        const FrameDecoder::Stats frames = decoder->stats();
+        out << QString(" frames=%1 frame_errors=%2").arg(frames.frames).arg(frames.errors());
+    }
+    if (triggers) {
+        out << QString(" trigger_matches=%1").arg(triggers->totalMatches());
+    }
+    out << Qt::endl;
+}
+
+// Builds the decoder named on the command line; returns null for an unknown name
+static std::unique_ptr<FrameDecoder> makeFrameDecoder(const QString &framing, const QString &crc) {
+    FrameDecoder::Checksum checksum = FrameDecoder::Checksum::None;
+    if (crc == "crc16") {
+        checksum = FrameDecoder::Checksum::Crc16;
+    } else if (crc == "crc32") {
+        checksum = FrameDecoder::Checksum::Crc32;
+    } else if (crc != "none") {
+        return nullptr;
+    }
+
+    if (framing == "cobs") {
+        return std::make_unique<CobsFrameDecoder>(checksum);
+    } else if (framing == "slip") {
+        return std::make_unique<SlipFrameDecoder>(checksum);
+    } else if (framing == "len8") {
+        return std::make_unique<LengthPrefixedFrameDecoder>(1, checksum);
+    } else if (framing == "len16") {
+        return std::make_unique<LengthPrefixedFrameDecoder>(2, checksum);
+    } else if (framing == "len32") {
+        return std::make_unique<LengthPrefixedFrameDecoder>(4, checksum);
+    }
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("terminal-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drive one or more serial ports without the GUI.");
+    parser.addHelpOption();
+    const QCommandLineOption portOption({"p", "port"}, "Serial port name or device path; repeat for several ports.", "port");
+    const QCommandLineOption baudOption({"b", "baud"}, "Baud rate.", "rate", "115200");
+    const QCommandLineOption sendOption({"s", "send"}, "Send the contents of <file> once connected.", "file");
+    const QCommandLineOption captureOption({"c", "capture"}, "Log traffic to <file>.", "file");
+    const QCommandLineOption binaryOption("binary", "Capture raw bytes with timestamps instead of text lines.");
+    const QCommandLineOption captureBytesOption("capture-max-mb",
+        "Start a new --capture file once it reaches <MB>; the old one gets a timestamp suffix.", "MB", "0");
+    const QCommandLineOption captureAgeOption("capture-max-age",
+        "Start a new --capture file once it is <seconds> old.", "seconds", "0");
+    const QCommandLineOption durationOption({"d", "duration"},
+        "Stop after <seconds>. Without it, stop once the file is sent, or run until killed.", "seconds");
+    const QCommandLineOption statsOption("stats-interval", "Also print stats every <ms>.", "ms");
+    const QCommandLineOption chunkOption("chunk", "Bytes per write() call.", "bytes");
+    const QCommandLineOption windowOption("window", "Bytes in flight before waiting for the port.", "bytes");
+    const QCommandLineOption echoOption("echo", "Copy received bytes to stdout.");
+    const QCommandLineOption framingOption("framing", "Decode received frames: cobs, slip, len8, len16 or len32.", "type");
+    const QCommandLineOption crcOption("crc", "Frame checksum: none, crc16 or crc32.", "type", "none");
+    const QCommandLineOption replayOption("replay", "Replay a --binary capture <file> out of the port.", "file");
+    const QCommandLineOption speedOption("speed", "Replay speed: 1 keeps the original timing, 0 is unthrottled.",
+                                         "factor", "1");
+    const QCommandLineOption replayFromOption("replay-from", "Start the replay <seconds> into the capture.", "seconds");
+    const QCommandLineOption replayRecordsOption("replay-records", "Records to replay: sent, received or all.",
+                                                 "which", "sent");
+    const QCommandLineOption replayGapOption("replay-max-gap",
+        "Shorten longer pauses in the capture to <seconds>; 0 keeps them all.", "seconds", "60");
+    const QCommandLineOption replayPreciseOption("replay-precise",
+        "Busy-wait the last 0.2 ms before each replayed record, holding the port's I/O thread.");
+    const QCommandLineOption flowOption("flow", "Flow control: none, rtscts or xonxoff.", "type", "none");
+    const QCommandLineOption uploadOption("upload", "Upload a firmware <file> with the windowed ACK protocol.", "file");
+    const QCommandLineOption uploadWindowOption("upload-window", "Blocks in flight during --upload.", "blocks", "16");
+    const QCommandLineOption uploadBlockOption("upload-block", "Block size for --upload.", "bytes", "1024");
+    const QCommandLineOption triggersOption("triggers", "Load trigger rules from <file>, one per line.", "file");
+    const QCommandLineOption triggerOption("trigger", "Add one rule in the --triggers syntax; repeatable.", "rule");
+    const QCommandLineOption scheduleOption("schedule",
+        "Send the timed messages in <file>, e.g. 'every 10ms \"A\"' or 'at 5s hex:0d0a'.", "file");
+    const QCommandLineOption missOption("miss-us", "A scheduled send later than this is a missed deadline.",
+                                        "us", "1000");
+    const QCommandLineOption telemetryOption("telemetry",
+        "Parse numeric key=value or CSV lines from each port and print per-channel statistics at exit.");
+    const QCommandLineOption channelsOption("telemetry-channels",
+        "Comma-separated channel names --telemetry may create; others are ignored.", "list");
+    parser.addOptions({portOption, baudOption, sendOption, captureOption, binaryOption, captureBytesOption,
+                       captureAgeOption, durationOption, statsOption, chunkOption, windowOption, echoOption,
+                       framingOption, crcOption, replayOption, speedOption, replayFromOption, replayRecordsOption,
+                       replayGapOption, replayPreciseOption, flowOption, uploadOption, uploadWindowOption,
+                       uploadBlockOption, triggersOption, triggerOption, scheduleOption, missOption,
+                       telemetryOption, channelsOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QStringList ports = parser.values(portOption);
+    if (ports.isEmpty()) {
+        err << "terminal-cli: --port is required" << Qt::endl;
+        return 2;
+    }
+
+    // Files are streamed once the port is open; only check they are readable here. Opening a
+    // FIFO would block until a writer appears, and neither path can stream one anyway
+    for (const QCommandLineOption &option : {sendOption, uploadOption}) {
+        QFile file(parser.value(option));
+        if (parser.isSet(option) && QFileInfo(file).exists() && !QFileInfo(file).isFile()) {
+            err << "terminal-cli: " << file.fileName() << " is not a regular file" << Qt::endl;
+            return 1;
+        }
+        if (parser.isSet(option) && !file.open(QIODevice::ReadOnly)) {
+            err << "terminal-cli: cannot read " << file.fileName() << ": " << file.errorString() << Qt::endl;
+            return 1;
+        }
+    }
+    const bool sending = parser.isSet(sendOption);
+    const bool uploading = parser.isSet(uploadOption);
+
+    QSerialPort::FlowControl flowControl = QSerialPort::NoFlowControl;
+    if (parser.value(flowOption) == "rtscts") {
+        flowControl = QSerialPort::HardwareControl;
+    } else if (parser.value(flowOption) == "xonxoff") {
+        flowControl = QSerialPort::SoftwareControl;
+    } else if (parser.value(flowOption) != "none") {
+        err << "terminal-cli: unknown --flow value" << Qt::endl;
+        return 2;
+    }
+
+    CaptureFile replayFile;
+    const bool replaying = parser.isSet(replayOption);
+    ReplayEngine::Records replayRecords = ReplayEngine::Records::Sent;
+    if (replaying) {
+        QString error;
+        if (!replayFile.open(parser.value(replayOption), &error)) {
+            err << "terminal-cli: cannot replay " << parser.value(replayOption) << ": " << error << Qt::endl;
+            return 1;
+        }
+        const QString which = parser.value(replayRecordsOption);
+        if (which == "received") {
+            replayRecords = ReplayEngine::Records::Received;
+        } else if (which == "all") {
+            replayRecords = ReplayEngine::Records::All;
+        } else if (which != "sent") {
+            err << "terminal-cli: unknown --replay-records value" << Qt::endl;
+            return 2;
+        }
+    }
+
+    // Rules are checked once up front; every port then compiles its own engine from them
+    QList<TriggerEngine::Trigger> triggerRules;
+    {
+        TriggerEngine rules;
+        QString error;
+        if (parser.isSet(triggersOption) && !rules.loadRules(parser.value(triggersOption), &error)) {
+            err << "terminal-cli: " << parser.value(triggersOption) << ": " << error << Qt::endl;
+            return 2;
+        }
+        for (const QString &rule : parser.values(triggerOption)) {
+            TriggerEngine::Trigger trigger;
+            if (!TriggerEngine::parseRule(rule, &trigger, &error) || rules.addTrigger(trigger, &error) < 0) {
+                err << "terminal-cli: bad --trigger '" << rule << "': " << error << Qt::endl;
+                return 2;
+            }
+        }
+        for (int id = 0; id < rules.triggerCount(); ++id) {
+            triggerRules << rules.trigger(id);
+        }
+    }
+
+    const bool scheduling = parser.isSet(scheduleOption);
+    if (scheduling) {
+        TransmitScheduler check;
+        QString error;
+        if (!check.loadSchedule(parser.value(scheduleOption), &error)) {
+            err << "terminal-cli: " << parser.value(scheduleOption) << ": " << error << Qt::endl;
+            return 2;
+        }
+    }
+
+    // Every port gets its own session, decoder and capture file; the sessions share a few I/O threads.
+    // The decoders, trigger engines and telemetry parsers are declared first so they outlive the
+    // sessions that feed them.
+    std::vector<std::unique_ptr<FrameDecoder>> decoders;
+    std::vector<std::unique_ptr<TriggerEngine>> triggerEngines;
+    std::vector<std::unique_ptr<TelemetryStore>> telemetryStores;
+    std::vector<std::unique_ptr<TelemetryParser>> telemetryParsers;
+    PortMonitor portMonitor;
+    SessionManager sessions;
+    sessions.setPortMonitor(&portMonitor);
+    // A full disk or failed rotation stops a capture; report each new failure once per port
+    QHash<int, QString> captureErrors;
+    QObject::connect(&sessions, &SessionManager::logWriteError, &app, [&](int id, const QString &message) {
+        if (captureErrors.value(id) != message) {
+            captureErrors.insert(id, message);
+            err << "terminal-cli: capture on " << sessions.portName(id) << " failed: " << message << Qt::endl;
+        }
+    });
+    QList<int> ids;
+    QList<ReplayEngine *> replays;  // Owned by their sessions
+    QList<WindowedUpload *> uploads;
+    QList<TransmitScheduler *> schedulers;
+
+    // Without --duration, stop once every send, replay and upload has finished
+    int tasksPending = 0;
+    const bool stopWhenDone = !parser.isSet(durationOption);
+    auto taskDone = [&tasksPending] {
+        if (--tasksPending == 0) {
+            QCoreApplication::quit();
+        }
+    };
+    for (const QString &port : ports) {
+        FirmwareUART *uart = new FirmwareUART;
+        if (parser.isSet(chunkOption)) {
+            uart->setChunkSize(parser.value(chunkOption).toInt());
+        }
+        if (parser.isSet(windowOption)) {
+            uart->setTransmitWindow(parser.value(windowOption).toLongLong());
+        }
+        uart->setFlowControl(flowControl);
+
+        std::unique_ptr<FrameDecoder> decoder;
+        if (parser.isSet(framingOption)) {
+            decoder = makeFrameDecoder(parser.value(framingOption), parser.value(crcOption));
+            if (!decoder) {
+                err << "terminal-cli: unknown --framing or --crc value" << Qt::endl;
+                delete uart;
+                return 2;
+            }
+            uart->setFrameDecoder(decoder.get());
+        }
+        decoders.push_back(std::move(decoder));
+
+        std::unique_ptr<TriggerEngine> triggers;
+        if (!triggerRules.isEmpty()) {
+            triggers = std::make_unique<TriggerEngine>();
+            for (const TriggerEngine::Trigger &trigger : std::as_const(triggerRules)) {
+                triggers->addTrigger(trigger);
+            }
+            triggers->compile();
+            uart->setTriggerEngine(triggers.get());
+
+            // One line per match, stamped with the arrival time of the read that completed it
+            const TriggerEngine *engine = triggers.get();
+            QObject::connect(uart, &FirmwareUART::triggerMatched, &app,
+                             [engine, port](int trigger, qint64 offset, qint64 timestampNs) {
+                QTextStream(stdout) << QString("trigger port=%1 name=%2 offset=%3 time_ns=%4")
+                                           .arg(port, engine->trigger(trigger).name)
+                                           .arg(offset)
+                                           .arg(timestampNs)
+                                    << Qt::endl;
+            });
+        }
+        triggerEngines.push_back(std::move(triggers));
+
+        if (parser.isSet(telemetryOption)) {
+            telemetryStores.push_back(std::make_unique<TelemetryStore>());
+            telemetryParsers.push_back(std::make_unique<TelemetryParser>(telemetryStores.back().get()));
+            QList<QByteArray> channels;
+            for (const QString &name : parser.value(channelsOption).split(',', Qt::SkipEmptyParts)) {
+                channels << name.trimmed().toUtf8();
+            }
+            telemetryParsers.back()->setChannelFilter(channels);
+            uart->setTelemetryParser(telemetryParsers.back().get());
+        }
+
+        if (parser.isSet(echoOption)) {
+            QObject::connect(uart, &FirmwareUART::dataReceived, &app, [](const QByteArray &data) {
+                fwrite(data.constData(), 1, size_t(data.size()), stdout);
+                fflush(stdout);
+            });
+        }
+        if (replaying) {
+            // Child of the session, so it moves to the session's I/O thread along with it
+            ReplayEngine *replay = new ReplayEngine(uart);
+            replay->setCapture(&replayFile);
+            replay->setTarget(uart);
+            replay->setRecords(replayRecords);
+            replay->setSpeed(parser.value(speedOption).toDouble());
+            replay->setMaxGap(qint64(parser.value(replayGapOption).toDouble() * 1e9));
+            replay->setPrecise(parser.isSet(replayPreciseOption));
+            if (stopWhenDone) {
+                ++tasksPending;
+                QObject::connect(replay, &ReplayEngine::finished, &app, taskDone);
+            }
+            replays << replay;
+        }
+
+        if (uploading) {
+            WindowedUpload *upload = new WindowedUpload(uart);
+            upload->setTarget(uart);
+            upload->setWindow(parser.value(uploadWindowOption).toInt());
+            upload->setBlockSize(parser.value(uploadBlockOption).toInt());
+            QObject::connect(upload, &WindowedUpload::finished, &app, [&err, port](bool ok, const QString &error) {
+                if (!ok) {
+                    err << "terminal-cli: upload to " << port << " failed: " << error << Qt::endl;
+                }
+            });
+            if (stopWhenDone) {
+                ++tasksPending;
+                QObject::connect(upload, &WindowedUpload::finished, &app, taskDone);
+            }
+            uploads << upload;
+        }
+
+        if (scheduling) {
+            TransmitScheduler *scheduler = new TransmitScheduler(uart);
+            scheduler->setTarget(uart);
+            scheduler->setMissThreshold(parser.value(missOption).toLongLong() * 1000);
+            scheduler->loadSchedule(parser.value(scheduleOption));
+            if (stopWhenDone) {
+                ++tasksPending;
+                QObject::connect(scheduler, &TransmitScheduler::finished, &app, taskDone);
+            }
+            schedulers << scheduler;
+        }
+
+        const int id = sessions.addSession(uart);
+        ids << id;
+
+        if (parser.isSet(captureOption)) {
+            // With several ports, each capture file gets the port name appended
+            QString path = parser.value(captureOption);
+            if (ports.size() > 1) {
+                const QFileInfo info(path);
+                const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+                path = info.path() + "/" + info.completeBaseName() + "-" + QFileInfo(port).fileName() + suffix;
+            }
+            const LogWriter::Format format = parser.isSet(binaryOption) ? LogWriter::Format::Binary
+                                                                        : LogWriter::Format::Text;
+            const qint64 maxFileBytes = qint64(parser.value(captureBytesOption).toDouble() * 1024 * 1024);
+            const qint64 maxFileAgeSecs = parser.value(captureAgeOption).toLongLong();
+            if (!sessions.setupSessionLog(id, path, format, maxFileBytes, maxFileAgeSecs)) {
+                err << "terminal-cli: cannot open capture file " << path << Qt::endl;
+                return 1;
+            }
+        }
+    }
+
+    auto printAll = [&] {
+        for (int i = 0; i < ids.size(); ++i) {
+            printStats(ports[i], sessions.sessionStats(ids[i]), sessions.session(ids[i])->logBytesWritten(),
+                       decoders[size_t(i)].get(), triggerEngines[size_t(i)].get());
+        }
+        if (ids.size() > 1) {
+            quint64 logWritten = 0;
+            for (const int id : std::as_const(ids)) {
+                logWritten += sessions.session(id)->logBytesWritten();
+            }
+            printStats("total", sessions.aggregateStats(), logWritten, nullptr, nullptr);
+        }
+    };
+
+    // An unplugged port disconnects its session; stop once none are left
+    QStringList portsLeft;
+    for (const QString &port : ports) {
+        portsLeft << QFileInfo(port).fileName();
+    }
+    QObject::connect(&portMonitor, &PortMonitor::portRemoved, &app, [&](const QSerialPortInfo &info) {
+        if (portsLeft.removeAll(info.portName()) > 0) {
+            err << "terminal-cli: " << info.portName() << " was removed" << Qt::endl;
+            if (portsLeft.isEmpty()) {
+                QCoreApplication::exit(1);
+            }
+        }
+    });
+
+    if (parser.isSet(durationOption)) {
+        QTimer::singleShot(int(parser.value(durationOption).toDouble() * 1000), &app, &QCoreApplication::quit);
+    }
+
+    QTimer statsTimer;
+    if (parser.isSet(statsOption)) {
+        QObject::connect(&statsTimer, &QTimer::timeout, printAll);
+        statsTimer.start(parser.value(statsOption).toInt());
+    }
+
+    for (int i = 0; i < ids.size(); ++i) {
+        if (!sessions.connectSession(ids[i], ports[i], parser.value(baudOption).toInt())) {
+            err << "terminal-cli: could not open " << ports[i] << Qt::endl;
+            return 1;
+        }
+    }
+
+    if (sending) {
+        const QString path = parser.value(sendOption);
+        for (int i = 0; i < ids.size(); ++i) {
+            FirmwareUART *uart = sessions.session(ids[i]);
+            if (stopWhenDone) {
+                ++tasksPending;
+                // Not dataSent(): triggers, schedules and replays on this port drain the queue too
+                QObject::connect(uart, &FirmwareUART::fileSent, &app, taskDone, Qt::SingleShotConnection);
+            }
+            bool started = false;
+            QMetaObject::invokeMethod(uart, [uart, path] { return uart->sendFile(path); },
+                                      Qt::BlockingQueuedConnection, &started);
+            if (!started) {
+                err << "terminal-cli: could not send " << path << " to " << ports[i] << Qt::endl;
+                return 1;
+            }
+        }
+    }
+
+    const QString uploadPath = parser.value(uploadOption);
+    for (int i = 0; i < uploads.size(); ++i) {
+        WindowedUpload *upload = uploads[i];
+        bool started = false;
+        QMetaObject::invokeMethod(upload, [upload, uploadPath] { return upload->start(uploadPath); },
+                                  Qt::BlockingQueuedConnection, &started);
+        if (!started) {
+            err << "terminal-cli: could not upload " << uploadPath << " to " << ports[i] << Qt::endl;
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < schedulers.size(); ++i) {
+        TransmitScheduler *scheduler = schedulers[i];
+        bool started = false;
+        QMetaObject::invokeMethod(scheduler, &TransmitScheduler::start, Qt::BlockingQueuedConnection, &started);
+        if (!started) {
+            err << "terminal-cli: could not start the schedule on " << ports[i] << Qt::endl;
+            return 1;
+        }
+    }
+
+    const qint64 replayFromNs = parser.isSet(replayFromOption)
+        ? replayFile.startTimeNs() + qint64(parser.value(replayFromOption).toDouble() * 1e9) : 0;
+    for (int i = 0; i < replays.size(); ++i) {
+        ReplayEngine *replay = replays[i];
+        bool started = false;
+        QMetaObject::invokeMethod(replay, [replay, replayFromNs] { return replay->start(replayFromNs); },
+                                  Qt::BlockingQueuedConnection, &started);
+        if (!started) {
+            err << "terminal-cli: could not start the replay on " << ports[i] << Qt::endl;
+            return 1;
+        }
+    }
+
+    const int status = app.exec();
+    for (ReplayEngine *replay : std::as_const(replays)) {
+        QMetaObject::invokeMethod(replay, &ReplayEngine::stop, Qt::BlockingQueuedConnection);
+    }
+    for (WindowedUpload *upload : std::as_const(uploads)) {
+        QMetaObject::invokeMethod(upload, &WindowedUpload::cancel, Qt::BlockingQueuedConnection);
+    }
+    for (TransmitScheduler *scheduler : std::as_const(schedulers)) {
+        QMetaObject::invokeMethod(scheduler, &TransmitScheduler::stop, Qt::BlockingQueuedConnection);
+    }
+    for (const int id : std::as_const(ids)) {
+        sessions.disconnectSession(id);
+    }
+    printAll();
+    for (int i = 0; i < replays.size(); ++i) {
+        QTextStream(stdout) << QString("port=%1 replayed_bytes=%2 replay_max_late_us=%3")
+                                   .arg(ports[i])
+                                   .arg(replays[i]->bytesReplayed())
+                                   .arg(replays[i]->maxLatenessNs() / 1000)
+                            << Qt::endl;
+    }
+    for (int i = 0; i < uploads.size(); ++i) {
+        QTextStream(stdout) << QString("port=%1 upload_retransmitted_blocks=%2")
+                                   .arg(ports[i])
+                                   .arg(uploads[i]->retransmittedBlocks())
+                            << Qt::endl;
+    }
+    for (int i = 0; i < schedulers.size(); ++i) {
+        // Lateness percentiles come from the send log; the counters cover the whole run
+        for (int entry = 0; entry < schedulers[i]->entryCount(); ++entry) {
+            const qint64 p99 = schedulers[i]->latenessPercentile(entry, 99);
+            const TransmitScheduler::EntryStats stats = schedulers[i]->entryStats(entry);
+            QTextStream(stdout) << QString("port=%1 schedule_entry=%2 sent=%3 missed=%4 skipped=%5 "
+                                           "late_mean_us=%6 late_p99_us=%7 late_max_us=%8")
+                                       .arg(ports[i])
+                                       .arg(entry)
+                                       .arg(stats.sent)
+                                       .arg(stats.missed())
+                                       .arg(stats.skipped)
+                                       .arg(stats.meanLatenessNs() / 1000)
+                                       .arg(p99 / 1000)
+                                       .arg(stats.maxLatenessNs / 1000)
+                                << Qt::endl;
+        }
+    }
+    for (size_t i = 0; i < telemetryStores.size(); ++i) {
+        const TelemetryStore &store = *telemetryStores[i];
+        for (int channel = 0; channel < store.channelCount(); ++channel) {
+            const TelemetryStore::ChannelStats stats = store.stats(channel);
+            QTextStream(stdout) << QString("port=%1 channel=%2 samples=%3 min=%4 max=%5 last=%6")
+                                       .arg(ports[int(i)], store.channelName(channel))
+                                       .arg(stats.samples)
+                                       .arg(stats.min)
+                                       .arg(stats.max)
+                                       .arg(stats.last)
+                                << Qt::endl;
+        }
+    }
+    sessions.shutdown();
+    return status;
+}
@@ -0,0 +1,172 @@
+#include "library/capturefile.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+CaptureFile::CaptureFile() : base(nullptr), recordsEnd(0), indexFromFooter(false) {}
+
+CaptureFile::~CaptureFile() {
+    close();
+}
+
+bool CaptureFile::open(const QString &filePath, QString *error) {
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    base = (size > 0) ? file.map(0, size) : nullptr;
+    if (!base || size < qint64(sizeof(LogWriter::BinaryMagic))
+        || memcmp(base, LogWriter::BinaryMagic, sizeof(LogWriter::BinaryMagic)) != 0) {
+        if (error) {
+            *error = base ? QString("not a binary capture file") : file.errorString();
+        }
+        close();
+        return false;
+    }
+
+    indexFromFooter = loadIndex();
+    if (!indexFromFooter) {
+        buildIndex();
+    }
+
+    // The last record lies within one index interval (or one writer batch) of the last entry
+    if (!index.empty()) {
+        for (Record record = recordAt(index.back().offset); record.isValid(); record = next(record)) {
+            lastRecord = record;
+        }
+    }
+    return true;
+}
+
+void CaptureFile::close() {
+    if (base) {
+        file.unmap(const_cast<uchar *>(base));
+        base = nullptr;
+    }
+    file.close();
+    recordsEnd = 0;
+    index.clear();
+    indexFromFooter = false;
+    lastRecord = Record();
+}
+
+bool CaptureFile::isOpen() const {
+    return base != nullptr;
+}
+
+bool CaptureFile::hasIndex() const {
+    return indexFromFooter;
+}
+
+// Reads the footer written by LogWriter::writeIndex(); false if it is missing or inconsistent
+bool CaptureFile::loadIndex() {
+    const qint64 size = file.size();
+    const qint64 headerBytes = qint64(sizeof(LogWriter::BinaryMagic));
+    if (size < headerBytes + FooterBytes
+        || memcmp(base + size - 8, LogWriter::IndexMagic, sizeof(LogWriter::IndexMagic)) != 0) {
+        return false;
+    }
+
+    const quint64 indexOffset = qFromLittleEndian<quint64>(base + size - FooterBytes);
+    const quint64 count = qFromLittleEndian<quint64>(base + size - FooterBytes + 8);
+    if (indexOffset < quint64(headerBytes) || indexOffset > quint64(size)
+        || count > quint64(size - FooterBytes - qint64(indexOffset)) / 16
+        || indexOffset + count * 16 + FooterBytes != quint64(size)) {
+        return false;
+    }
+
+    recordsEnd = qint64(indexOffset);
+    index.reserve(size_t(count));
+    const uchar *entry = base + indexOffset;
+    for (quint64 i = 0; i < count; ++i, entry += 16) {
+        const qint64 timestampNs = qint64(qFromLittleEndian<quint64>(entry));
+        const qint64 offset = qint64(qFromLittleEndian<quint64>(entry + 8));
+        if (offset < headerBytes || offset >= recordsEnd || (!index.empty() && offset <= index.back().offset)) {
+            index.clear();
+            return false;
+        }
+        // The wall clock can step backwards; keep the index sorted so the search stays valid
+        index.push_back({index.empty() ? timestampNs : std::max(timestampNs, index.back().timestampNs), offset});
+    }
+    return true;
+}
+
+// Recovers an index from an unterminated file by walking the record headers once
+void CaptureFile::buildIndex() {
+    recordsEnd = file.size();
+    qint64 offset = qint64(sizeof(LogWriter::BinaryMagic));
+    qint64 lastIndexed = -LogWriter::IndexIntervalBytes;
+    while (offset + RecordHeaderBytes <= recordsEnd) {
+        const qint64 length = qint64(qFromLittleEndian<quint32>(base + offset + 9));
+        if (offset + RecordHeaderBytes + length > recordsEnd) {
+            break; // Torn final record
+        }
+        if (offset - lastIndexed >= LogWriter::IndexIntervalBytes) {
+            const qint64 timestampNs = qint64(qFromLittleEndian<quint64>(base + offset));
+            index.push_back({index.empty() ? timestampNs : std::max(timestampNs, index.back().timestampNs), offset});
+            lastIndexed = offset;
+        }
+        offset += RecordHeaderBytes + length;
+    }
+    recordsEnd = offset;
+}
+
+CaptureFile::Record CaptureFile::recordAt(qint64 offset) const {
+    Record record;
+    if (!base || offset < qint64(sizeof(LogWriter::BinaryMagic)) || offset + RecordHeaderBytes > recordsEnd) {
+        return record;
+    }
+
+    const uchar *header = base + offset;
+    const qint64 length = qint64(qFromLittleEndian<quint32>(header + 9));
+    if (offset + RecordHeaderBytes + length > recordsEnd) {
+        return record;
+    }
+
+    record.offset = offset;
+    record.timestampNs = qint64(qFromLittleEndian<quint64>(header));
+    record.direction = LogWriter::Direction(header[8]);
+    record.payload = QByteArrayView(reinterpret_cast<const char *>(header + RecordHeaderBytes), length);
+    return record;
+}
+
+CaptureFile::Record CaptureFile::first() const {
+    return recordAt(qint64(sizeof(LogWriter::BinaryMagic)));
+}
+
+CaptureFile::Record CaptureFile::next(const Record &record) const {
+    if (!record.isValid()) {
+        return Record();
+    }
+    return recordAt(record.offset + RecordHeaderBytes + record.payload.size());
+}
+
+CaptureFile::Record CaptureFile::seek(qint64 timestampNs) const {
+    // Last index entry at or before the target, then a short forward scan
+    auto entry = std::upper_bound(index.begin(), index.end(), timestampNs,
+                                  [](qint64 value, const IndexEntry &e) { return value < e.timestampNs; });
+    Record record = (entry == index.begin()) ? first() : recordAt(std::prev(entry)->offset);
+    while (record.isValid() && record.timestampNs < timestampNs) {
+        record = next(record);
+    }
+    return record;
+}
+
+qint64 CaptureFile::startTimeNs() const {
+    return first().timestampNs;
+}
+
+qint64 CaptureFile::endTimeNs() const {
+    return lastRecord.timestampNs;
+}
+
+qint64 CaptureFile::recordBytes() const {
+    return base ? recordsEnd - qint64(sizeof(LogWriter::BinaryMagic)) : 0;
+}
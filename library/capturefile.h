@@ -0,0 +1,66 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "library/logwriter.h"
+
+// The CaptureFile class reads binary captures written by LogWriter (Format::Binary).
+// The file is memory-mapped rather than read, so opening a multi-gigabyte capture costs
+// only the footer index, and payloads are handed out as views into the mapping.
+// seek() binary-searches the index and then scans at most one index interval.
+// Files without a footer (the writer crashed, or is still writing) are indexed by a
+// single scan of the record headers on open; a torn final record is ignored.
+// All const methods are safe to call from several threads at once.
+class CaptureFile
+{
+public:
+    struct Record {
+        qint64 offset = -1;           // File offset of the record header; -1 past the end
+        qint64 timestampNs = 0;       // ns since the Unix epoch
+        LogWriter::Direction direction = LogWriter::Direction::Received;
+        QByteArrayView payload;       // Points into the mapping; valid until close()
+
+        bool isValid() const { return offset >= 0; }
+    };
+
+    CaptureFile();
+    ~CaptureFile();
+
+    bool open(const QString &filePath, QString *error = nullptr);
+    void close();
+    bool isOpen() const;
+    bool hasIndex() const;            // False if the index had to be rebuilt by scanning
+
+    Record first() const;
+    Record next(const Record &record) const;
+    Record recordAt(qint64 offset) const;
+    Record seek(qint64 timestampNs) const; // First record at or after timestampNs
+
+    qint64 startTimeNs() const;       // Timestamps of the first and last records, 0 if empty
+    qint64 endTimeNs() const;
+    qint64 recordBytes() const;       // Bytes of records, excluding the magic and the footer
+
+    static constexpr qsizetype RecordHeaderBytes = 13;
+    static constexpr qsizetype FooterBytes = 24;
+
+private:
+    struct IndexEntry {
+        qint64 timestampNs;
+        qint64 offset;
+    };
+
+    bool loadIndex();
+    void buildIndex();
+
+    QFile file;
+    const uchar *base;
+    qint64 recordsEnd;                // One past the last complete record
+    std::vector<IndexEntry> index;    // Sorted by timestamp and by offset
+    bool indexFromFooter;
+    Record lastRecord;
+};
+
+#endif // CAPTUREFILE_H
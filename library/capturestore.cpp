@@ -0,0 +1,119 @@
+#include "library/capturestore.h"
+#include <algorithm>
+#include <cstring>
+
+CaptureStore::CaptureStore(qint64 maxBytes)
+    : lastTimestampNs(0), limit(qMax<qint64>(0, maxBytes)), totalBytes(0), dropped(0) {}
+
+void CaptureStore::append(Direction direction, const char *data, qsizetype length, qint64 timestampNs) {
+    if (length <= 0) {
+        return;
+    }
+
+    QWriteLocker locker(&lock);
+    qint64 offset = totalBytes.load(std::memory_order_relaxed);
+    const qsizetype accepted = qsizetype(qMin<qint64>(length, limit - offset));
+    if (accepted < length) {
+        dropped.fetch_add(length - qMax<qsizetype>(accepted, 0), std::memory_order_relaxed);
+        if (accepted <= 0) {
+            return;
+        }
+    }
+
+    // Merge into the previous segment unless the direction changed or the line went quiet
+    if (segments.empty() || segments.back().direction != direction
+        || timestampNs - lastTimestampNs > SegmentGapNs) {
+        segments.push_back({offset, timestampNs, direction});
+    }
+    lastTimestampNs = timestampNs;
+
+    qsizetype copied = 0;
+    while (copied < accepted) {
+        const qsizetype within = qsizetype(offset % ChunkBytes);
+        if (within == 0 && qsizetype(offset / ChunkBytes) == qsizetype(chunks.size())) {
+            chunks.push_back({std::unique_ptr<char[]>(new char[ChunkBytes]), qsizetype(segments.size()) - 1});
+        }
+        const qsizetype count = qMin(accepted - copied, ChunkBytes - within);
+        std::memcpy(chunks[size_t(offset / ChunkBytes)].data.get() + within, data + copied, size_t(count));
+        copied += count;
+        offset += count;
+    }
+
+    totalBytes.store(offset, std::memory_order_release);
+}
+
+void CaptureStore::clear() {
+    QWriteLocker locker(&lock);
+    chunks.clear();
+    segments.clear();
+    lastTimestampNs = 0;
+    totalBytes.store(0, std::memory_order_release);
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+void CaptureStore::setMaxBytes(qint64 maxBytes) {
+    QWriteLocker locker(&lock);
+    limit = qMax<qint64>(0, maxBytes);
+}
+
+qint64 CaptureStore::maxBytes() const {
+    QReadLocker locker(&lock);
+    return limit;
+}
+
+qint64 CaptureStore::size() const {
+    return totalBytes.load(std::memory_order_acquire);
+}
+
+qint64 CaptureStore::droppedBytes() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+qsizetype CaptureStore::segmentAt(qint64 offset) const {
+    // The chunk index narrows the search to the segments that overlap one chunk
+    const size_t chunk = size_t(offset / ChunkBytes);
+    const auto first = segments.begin() + chunks[chunk].firstSegment;
+    const auto last = (chunk + 1 < chunks.size()) ? segments.begin() + chunks[chunk + 1].firstSegment + 1
+                                                  : segments.end();
+    const auto next = std::upper_bound(first, last, offset, [](qint64 value, const Segment &segment) {
+        return value < segment.offset;
+    });
+    return qsizetype(next - segments.begin()) - 1;
+}
+
+qsizetype CaptureStore::read(qint64 offset, char *data, qsizetype length, Direction *directions) const {
+    QReadLocker locker(&lock);
+    const qint64 available = totalBytes.load(std::memory_order_relaxed) - offset;
+    if (offset < 0 || available <= 0 || length <= 0) {
+        return 0;
+    }
+    const qsizetype count = qsizetype(qMin<qint64>(length, available));
+
+    qsizetype copied = 0;
+    while (copied < count) {
+        const qint64 position = offset + copied;
+        const qsizetype within = qsizetype(position % ChunkBytes);
+        const qsizetype piece = qMin(count - copied, ChunkBytes - within);
+        std::memcpy(data + copied, chunks[size_t(position / ChunkBytes)].data.get() + within, size_t(piece));
+        copied += piece;
+    }
+
+    if (directions) {
+        qsizetype segment = segmentAt(offset);
+        for (qsizetype i = 0; i < count; ++i) {
+            while (segment + 1 < qsizetype(segments.size()) && segments[size_t(segment + 1)].offset <= offset + i) {
+                ++segment;
+            }
+            directions[i] = segments[size_t(segment)].direction;
+        }
+    }
+    return count;
+}
+
+qint64 CaptureStore::timestampAt(qint64 offset) const {
+    QReadLocker locker(&lock);
+    if (offset < 0 || offset >= totalBytes.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    return segments[size_t(segmentAt(offset))].timestampNs;
+}
@@ -0,0 +1,65 @@
+#ifndef CAPTURESTORE_H
+#define CAPTURESTORE_H
+
+#include <QReadWriteLock>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// The CaptureStore class keeps every byte sent and received in fixed-size chunks
+// allocated once and never moved, so memory stays close to the raw byte count.
+// Direction and arrival time are kept per run of bytes (a segment), not per byte or
+// line, and each chunk records its first segment so lookups by offset stay cheap.
+// append() is called from the I/O thread while views read from the GUI thread.
+// Memory grows a chunk at a time up to maxBytes(); bytes beyond it are counted, not kept.
+class CaptureStore
+{
+public:
+    enum class Direction : quint8 {
+        Received = 0,
+        Sent = 1
+    };
+
+    explicit CaptureStore(qint64 maxBytes = DefaultMaxBytes);
+
+    void append(Direction direction, const char *data, qsizetype length, qint64 timestampNs);
+    void clear();
+    void setMaxBytes(qint64 maxBytes); // Bytes already stored are kept even if over the new limit
+    qint64 maxBytes() const;
+
+    qint64 size() const;          // Bytes stored; safe to poll from any thread
+    qint64 droppedBytes() const;  // Bytes refused once maxBytes was reached
+
+    // Copies up to length bytes starting at offset, and optionally the direction of each
+    qsizetype read(qint64 offset, char *data, qsizetype length, Direction *directions = nullptr) const;
+    qint64 timestampAt(qint64 offset) const; // Arrival time (ns since the epoch) of the segment holding offset
+
+    static constexpr qsizetype ChunkBytes = 1 << 20;
+    static constexpr qint64 DefaultMaxBytes = qint64(64) << 20; // Minutes of traffic at 1 Mbaud
+    static constexpr qint64 SegmentGapNs = 10000000; // Start a new segment after 10 ms of silence
+
+private:
+    struct Segment {
+        qint64 offset;      // First byte of the segment
+        qint64 timestampNs;
+        Direction direction;
+    };
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        qsizetype firstSegment; // Segment containing the chunk's first byte
+    };
+
+    qsizetype segmentAt(qint64 offset) const; // Caller holds the lock
+
+    mutable QReadWriteLock lock;
+    std::vector<Chunk> chunks;
+    std::vector<Segment> segments;
+    qint64 lastTimestampNs;
+    qint64 limit;
+    std::atomic<qint64> totalBytes;
+    std::atomic<qint64> dropped;
+};
+
+#endif // CAPTURESTORE_H
@@ -0,0 +1,190 @@
+#include "library/consolerenderer.h"
+#include <QColor>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextCursor>
+
+ConsoleRenderer::ConsoleRenderer(QPlainTextEdit *console, QObject *parent)
+    : QObject(parent), console(console), decoder(QStringDecoder::Utf8),
+      lineFilter(nullptr), atLineStart(true), flushRate(DefaultFlushRate), byteLimit(DefaultScrollbackBytes) {
+    // Undo history would keep a copy of everything ever appended
+    console->setReadOnly(true);
+    console->setUndoRedoEnabled(false);
+    console->setMaximumBlockCount(DefaultScrollbackLines);
+
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(1000 / flushRate);
+    connect(&flushTimer, &QTimer::timeout, this, &ConsoleRenderer::flush);
+
+    partialLineTimer.setSingleShot(true);
+    partialLineTimer.setInterval(PartialLineMs);
+    connect(&partialLineTimer, &QTimer::timeout, this, &ConsoleRenderer::releasePartialLine);
+}
+
+void ConsoleRenderer::setMaxFlushRate(int flushesPerSecond) {
+    flushRate = qBound(1, flushesPerSecond, 1000);
+    flushTimer.setInterval(1000 / flushRate);
+}
+
+int ConsoleRenderer::maxFlushRate() const {
+    return flushRate;
+}
+
+void ConsoleRenderer::setScrollbackLines(int lines) {
+    console->setMaximumBlockCount(qMax(0, lines));
+}
+
+int ConsoleRenderer::scrollbackLines() const {
+    return console->maximumBlockCount();
+}
+
+void ConsoleRenderer::setScrollbackBytes(qint64 bytes) {
+    byteLimit = qMax<qint64>(0, bytes);
+    trimToByteLimit();
+}
+
+qint64 ConsoleRenderer::scrollbackBytes() const {
+    return byteLimit;
+}
+
+void ConsoleRenderer::setTriggerEngine(const TriggerEngine *engine) {
+    releasePartialLine();
+    lineFilter = (engine && engine->hasLineActions()) ? engine : nullptr;
+}
+
+void ConsoleRenderer::appendData(const QByteArray &data) {
+    if (!lineFilter) {
+        queueText(decoder.decode(data));
+        return;
+    }
+
+    partialLine += data;
+    qsizetype start = 0;
+    for (qsizetype end = partialLine.indexOf('\n'); end >= 0; end = partialLine.indexOf('\n', start)) {
+        queueLine(QByteArrayView(partialLine).sliced(start, end + 1 - start));
+        start = end + 1;
+    }
+    partialLine.remove(0, start);
+
+    // The engine splits long lines for its own matching; do the same here
+    if (partialLine.size() >= TriggerEngine::MaxLineBytes) {
+        releasePartialLine();
+    } else if (!partialLine.isEmpty()) {
+        partialLineTimer.start();
+    }
+}
+
+void ConsoleRenderer::queueLine(QByteArrayView line) {
+    QByteArrayView content = line;
+    if (content.endsWith('\n')) {
+        content.chop(1);
+    }
+    if (content.endsWith('\r')) {
+        content.chop(1);
+    }
+    const TriggerEngine::LineStyle style = lineFilter->classifyLine(content);
+    if (!style.hidden) {
+        queueText(decoder.decode(line), style.highlight);
+    }
+}
+
+void ConsoleRenderer::releasePartialLine() {
+    partialLineTimer.stop();
+    if (lineFilter && !partialLine.isEmpty()) {
+        queueLine(partialLine);
+    }
+    partialLine.clear();
+}
+
+void ConsoleRenderer::appendLine(const QString &line) {
+    queueText(atLineStart ? line + '\n' : '\n' + line + '\n');
+}
+
+void ConsoleRenderer::queueText(const QString &text, const QString &highlight) {
+    if (text.isEmpty()) {
+        return;
+    }
+    if (!highlight.isEmpty()) {
+        pendingHighlights.append({pending.size(), text.size(), highlight});
+    }
+    pending += text;
+    atLineStart = text.endsWith('\n');
+
+    // Text that would be trimmed straight after the flush is not worth keeping
+    if (byteLimit > 0 && pending.size() > byteLimit) {
+        const qsizetype cut = pending.size() - byteLimit;
+        pending.remove(0, cut);
+        for (Highlight &range : pendingHighlights) {
+            const qsizetype end = qMax<qsizetype>(0, range.start + range.length - cut);
+            range.start = qMax<qsizetype>(0, range.start - cut);
+            range.length = end - range.start;
+        }
+        pendingHighlights.removeIf([](const Highlight &range) { return range.length == 0; });
+    }
+
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void ConsoleRenderer::flush() {
+    flushTimer.stop();
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    // Follow the output only if the user has not scrolled up to read history
+    QScrollBar *scrollBar = console->verticalScrollBar();
+    const bool followTail = scrollBar->value() == scrollBar->maximum();
+
+    // One edit per flush: the document lays out once however many chunks were merged
+    // A plain format, or the text would pick up the highlight of whatever it follows
+    QTextCursor cursor(console->document());
+    cursor.movePosition(QTextCursor::End);
+    const int base = cursor.position();
+    cursor.insertText(pending, QTextCharFormat());
+    for (const Highlight &range : std::as_const(pendingHighlights)) {
+        QTextCharFormat format;
+        format.setBackground(QColor(range.color));
+        cursor.setPosition(base + int(range.start));
+        cursor.setPosition(base + int(range.start + range.length), QTextCursor::KeepAnchor);
+        cursor.mergeCharFormat(format);
+    }
+    pending.clear();
+    pendingHighlights.clear();
+    trimToByteLimit();
+
+    if (followTail) {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+}
+
+void ConsoleRenderer::trimToByteLimit() {
+    QTextDocument *document = console->document();
+    const qint64 excess = qint64(document->characterCount()) - byteLimit;
+    if (byteLimit <= 0 || excess <= 0) {
+        return;
+    }
+
+    // Cut whole lines from the top so the first visible line is never half a line,
+    // unless the surplus is all one unbroken line
+    QTextCursor cursor(document);
+    cursor.setPosition(int(qMin<qint64>(excess, document->characterCount() - 1)), QTextCursor::KeepAnchor);
+    if (!cursor.atBlockStart() && cursor.block().next().isValid()) {
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
+    }
+    cursor.removeSelectedText();
+}
+
+void ConsoleRenderer::clear() {
+    flushTimer.stop();
+    partialLineTimer.stop();
+    pending.clear();
+    pendingHighlights.clear();
+    partialLine.clear();
+    decoder.resetState();
+    atLineStart = true;
+    console->clear();
+}
@@ -0,0 +1,70 @@
+#ifndef CONSOLERENDERER_H
+#define CONSOLERENDERER_H
+
+#include <QObject>
+#include <QPlainTextEdit>
+#include <QStringDecoder>
+#include <QTimer>
+#include "library/triggerengine.h"
+
+// The ConsoleRenderer class batches text bound for the console and flushes it a bounded
+// number of times per second. Scrollback is capped in lines and in characters; the
+// oldest content is dropped first, so memory and per-flush cost stay flat over time.
+// With a trigger engine attached, text is passed on a line at a time so that its Hide,
+// Show and Highlight triggers can act on whole lines.
+class ConsoleRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConsoleRenderer(QPlainTextEdit *console, QObject *parent = nullptr);
+
+    // Rendering limits
+    void setMaxFlushRate(int flushesPerSecond);
+    int maxFlushRate() const;
+    void setScrollbackLines(int lines);       // 0 disables the line limit
+    int scrollbackLines() const;
+    void setScrollbackBytes(qint64 bytes);    // 0 disables the size limit
+    qint64 scrollbackBytes() const;
+
+    // Line filtering; the engine is not owned and must stay compiled while attached.
+    // An unfinished line is held until its newline, or shown as it is after PartialLineMs.
+    void setTriggerEngine(const TriggerEngine *engine);
+
+public slots:
+    void appendData(const QByteArray &data);  // Raw stream bytes, decoded as UTF-8
+    void appendLine(const QString &line);     // A message on a line of its own
+    void flush();                             // Push pending text to the console now
+    void clear();
+
+private:
+    struct Highlight {
+        qsizetype start;      // Position in pending
+        qsizetype length;
+        QString color;
+    };
+
+    void queueText(const QString &text, const QString &highlight = QString());
+    void queueLine(QByteArrayView line);     // Filters one line, its newline included if any
+    void releasePartialLine();
+    void trimToByteLimit();
+
+    QPlainTextEdit *console;
+    QTimer flushTimer;
+    QStringDecoder decoder;   // Keeps multi-byte sequences split across reads intact
+    QString pending;          // Text received since the last flush
+    QList<Highlight> pendingHighlights;
+    const TriggerEngine *lineFilter;
+    QByteArray partialLine;   // Bytes after the last newline, while filtering
+    QTimer partialLineTimer;
+    bool atLineStart;         // Whether the last queued character ended a line
+    int flushRate;
+    qint64 byteLimit;
+
+    static constexpr int DefaultFlushRate = 30;                 // Flushes per second
+    static constexpr int DefaultScrollbackLines = 10000;
+    static constexpr qint64 DefaultScrollbackBytes = 4 << 20;   // Characters kept in the console
+    static constexpr int PartialLineMs = 500;                   // Prompts show up after this long
+};
+
+#endif // CONSOLERENDERER_H
@@ -0,0 +1,74 @@
+#include "library/crc.h"
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr std::array<quint16, 256> makeCrc16Table() {
+    std::array<quint16, 256> table {};
+    for (int i = 0; i < 256; ++i) {
+        quint16 crc = quint16(i << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+// Table k advances the CRC over a byte followed by k zero bytes, which is what lets
+// crc32() fold eight input bytes per step (slicing-by-8)
+constexpr std::array<std::array<quint32, 256>, 8> makeCrc32Tables() {
+    std::array<std::array<quint32, 256>, 8> tables {};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (quint32 i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<quint16, 256> Crc16Table = makeCrc16Table();
+constexpr std::array<std::array<quint32, 256>, 8> Crc32Tables = makeCrc32Tables();
+
+} // namespace
+
+quint16 crc16Ccitt(const char *data, qsizetype length, quint16 crc) {
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    for (qsizetype i = 0; i < length; ++i) {
+        crc = quint16((crc << 8) ^ Crc16Table[((crc >> 8) ^ bytes[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+quint32 crc32(const char *data, qsizetype length, quint32 crc) {
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    crc = ~crc;
+
+    while (length >= 8) {
+        quint32 low;
+        quint32 high;
+        std::memcpy(&low, bytes, 4);
+        std::memcpy(&high, bytes + 4, 4);
+        low = qFromLittleEndian(low) ^ crc;
+        high = qFromLittleEndian(high);
+        crc = Crc32Tables[7][low & 0xFF] ^ Crc32Tables[6][(low >> 8) & 0xFF] ^
+              Crc32Tables[5][(low >> 16) & 0xFF] ^ Crc32Tables[4][low >> 24] ^
+              Crc32Tables[3][high & 0xFF] ^ Crc32Tables[2][(high >> 8) & 0xFF] ^
+              Crc32Tables[1][(high >> 16) & 0xFF] ^ Crc32Tables[0][high >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ Crc32Tables[0][(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
@@ -0,0 +1,15 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <QtGlobal>
+
+// Table-driven checksums for framed device traffic.
+// Both calls can be chained over split buffers by passing the previous result back in.
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection
+quint16 crc16Ccitt(const char *data, qsizetype length, quint16 crc = 0xFFFF);
+
+// CRC-32 (IEEE 802.3, as used by zlib and Ethernet), computed eight bytes at a time
+quint32 crc32(const char *data, qsizetype length, quint32 crc = 0);
+
+#endif // CRC_H
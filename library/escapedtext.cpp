@@ -0,0 +1,64 @@
+#include "library/escapedtext.h"
+
+bool readQuotedBytes(const QString &text, qsizetype &pos, QByteArray *out) {
+    if (pos >= text.size() || text[pos] != '"') {
+        return false;
+    }
+    ++pos;
+    while (pos < text.size()) {
+        const QChar c = text[pos++];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            const qsizetype length = (c.isHighSurrogate() && pos < text.size()) ? 2 : 1;
+            out->append(text.mid(pos - 1, length).toUtf8());
+            pos += length - 1;
+            continue;
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        switch (text[pos++].unicode()) {
+        case 'n': out->append('\n'); break;
+        case 'r': out->append('\r'); break;
+        case 't': out->append('\t'); break;
+        case '0': out->append('\0'); break;
+        case '\\': out->append('\\'); break;
+        case '"': out->append('"'); break;
+        case 'x': {
+            bool ok = false;
+            const int value = text.mid(pos, 2).toInt(&ok, 16);
+            if (!ok || pos + 2 > text.size()) {
+                return false;
+            }
+            out->append(char(value));
+            pos += 2;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+bool readHexBytes(const QString &text, qsizetype &pos, QByteArray *out) {
+    if (!text.mid(pos, 4).startsWith("hex:", Qt::CaseInsensitive)) {
+        return false;
+    }
+    qsizetype end = pos + 4;
+    QString digits;
+    for (; end < text.size() && !text[end].isSpace(); ++end) {
+        if (text[end] != '-' && text[end] != ':') {
+            digits += text[end];
+        }
+    }
+    const QByteArray bytes = QByteArray::fromHex(digits.toLatin1());
+    if (digits.isEmpty() || digits.size() % 2 != 0 || bytes.size() * 2 != digits.size()) {
+        return false;
+    }
+    out->append(bytes);
+    pos = end;
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef ESCAPEDTEXT_H
+#define ESCAPEDTEXT_H
+
+#include <QByteArray>
+#include <QString>
+
+// Byte strings written in rule and schedule files.
+// Both calls start at text[pos] and, on success, leave pos just past what they read.
+
+// "..." with \n \r \t \0 \\ \" and \xHH escapes; other characters are taken as UTF-8
+bool readQuotedBytes(const QString &text, qsizetype &pos, QByteArray *out);
+
+// hex:0d0a or hex:0D-0A-FF; pairs may be separated by '-' or ':', and the string ends at whitespace
+bool readHexBytes(const QString &text, qsizetype &pos, QByteArray *out);
+
+#endif // ESCAPEDTEXT_H
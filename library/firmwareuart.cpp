@@ -1,10 +1,41 @@
-#include "library/FirmwareUART.h"
+#include "library/firmwareuart.h"
+#include "library/spscringbuffer.h"
 #include <QElapsedTimer>
-#include <QTextStream>
+#include <QFileInfo>
 #include <QDebug>
+#include <algorithm>
+#include <chrono>
+
+// Wall-clock time in nanoseconds, the same epoch the binary log uses
+static qint64 captureTimestampNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Monotonic time in nanoseconds, for consumers that order samples by time and must not see
+// the wall clock step backwards
+static qint64 monotonicTimestampNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 FirmwareUART::FirmwareUART(QObject *parent)
-    : QObject(parent), serialPort(new QSerialPort(this)), logFile(nullptr), loggingEnabled(false) {}
+    : QObject(parent), serialPort(new QSerialPort(this)), connected(false), logWriter(new LogWriter(this)),
+      flowControlMode(QSerialPort::NoFlowControl),
+      txBase(0), txQueued(0), txWritten(0), txTotal(0), txLastReportMs(0), txActive(false),
+      txChunkSize(DefaultChunkSize), txWindowBytes(DefaultWindowBytes),
+      txFile(nullptr), txMapping(nullptr), txDevice(nullptr), txDeviceEnded(false),
+      rxBuffer(nullptr), rxDecoder(nullptr), rxTriggers(nullptr), rxTelemetry(nullptr), captureStore(nullptr), rxNotifyPending(false), rxOverrunBytes(0), rxOverrunCount(0),
+      metricsTimer(new QTimer(this)) {
+    // Connected once here so reconnecting does not stack duplicate connections
+    connect(serialPort, &QSerialPort::readyRead, this, &FirmwareUART::receiveData);
+    connect(serialPort, &QSerialPort::bytesWritten, this, &FirmwareUART::handleBytesWritten);
+    connect(serialPort, &QSerialPort::errorOccurred, this, &FirmwareUART::handleError);
+    connect(logWriter, &LogWriter::writeError, this, &FirmwareUART::logWriteError); // Queued from the writer thread
+
+    metricsTimer->setInterval(MetricsSampleMs);
+    connect(metricsTimer, &QTimer::timeout, this, [this] { metrics.sample(); });
+}
 
 FirmwareUART::~FirmwareUART() {
     if (serialPort->isOpen()) {
@@ -18,6 +49,7 @@ bool FirmwareUART::connectToPort(const QString &portName, int baudRate) {
     if (serialPort->isOpen()) {
         serialPort->close();
     }
+    resetTransmit();
 
     // Set up port parameters
     serialPort->setPortName(portName);
@@ -25,15 +57,28 @@ bool FirmwareUART::connectToPort(const QString &portName, int baudRate) {
     serialPort->setDataBits(QSerialPort::Data8);
     serialPort->setParity(QSerialPort::NoParity);
     serialPort->setStopBits(QSerialPort::OneStop);
-    serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    serialPort->setFlowControl(flowControlMode);
 
     // Try to open the port and connect signal for receiving data
     if (serialPort->open(QIODevice::ReadWrite)) {
-        connect(serialPort, &QSerialPort::readyRead, this, &FirmwareUART::receiveData);
+        // Every connection starts its statistics and framing from zero
+        metrics.reset();
+        if (rxDecoder) {
+            rxDecoder->reset();
+        }
+        if (rxTriggers) {
+            rxTriggers->reset();
+        }
+        if (rxTelemetry) {
+            rxTelemetry->reset();
+        }
+        metricsTimer->start();
+        connected = true;
         emit connectionStatusChanged(true);
         sendData(); // Send initial data upon connection
         return true;
     } else {
+        connected = false;
         emit connectionStatusChanged(false);
         return false;
     }
@@ -41,111 +86,472 @@ bool FirmwareUART::connectToPort(const QString &portName, int baudRate) {
 
 void FirmwareUART::disconnectFromPort() {
     // Close the port and update connection status
+    resetTransmit();
     if (serialPort->isOpen()) {
         serialPort->close();
+        metricsTimer->stop();
+        metrics.sample(); // Keep the final rates readable after disconnecting
+        connected = false;
         emit connectionStatusChanged(false);
     }
 }
 
 bool FirmwareUART::isConnected() const {
-    return serialPort && serialPort->isOpen();
+    return connected;
 }
 
 void FirmwareUART::sendData() {
-    // Check if serial port is open
-    if (!serialPort || !serialPort->isOpen()) {
+    // Check if serial port is open and no transfer is already running
+    if (!serialPort || !serialPort->isOpen() || isTransmitting()) {
         return;
     }
 
-    QByteArray data = dataToSend.toUtf8();
-    QElapsedTimer timer;
-    qint64 totalBytesSent = 0;
+    beginTransmit(dataToSend, dataToSend.size());
+    if (txData.isEmpty()) {
+        resetTransmit();
+        emit dataSent();
+        return;
+    }
 
-    for (int i = 0; i < data.size(); i += PacketSize) {
-        QByteArray packet = data.mid(i, PacketSize);
-        timer.restart();
+    // Prime the window; handleBytesWritten() keeps it topped up from here on
+    fillTransmitWindow();
+}
 
-        qint64 bytesSent = serialPort->write(packet);
-        serialPort->flush();
-        serialPort->waitForBytesWritten();
-        totalBytesSent += bytesSent;
+bool FirmwareUART::sendFile(const QString &filePath) {
+    if (!serialPort->isOpen() || isTransmitting()) {
+        return false;
+    }
 
-        // Calculate speed in bits per second
-        qint64 elapsedUs = timer.elapsed() * 1000;  // Convert to microseconds
-        double speedBps = (elapsedUs > 0) ? (bytesSent * 8 * 1e6) / elapsedUs : 0.0;
-        emit transmissionSpeedUpdated(speedBps);
+    // A FIFO or device node never signals readyRead() or readChannelFinished() through QFile,
+    // and opening or reading one can block this thread; such sources go through sendDevice()
+    if (!QFileInfo(filePath).isFile()) {
+        return false;
+    }
+    txFile = new QFile(filePath, this);
+    if (!txFile->open(QIODevice::ReadOnly)) {
+        delete txFile;
+        txFile = nullptr;
+        return false;
+    }
 
-        // Emit data and speed to UI
-        QString message = QString("Sent data: %1 - Speed: %2 bps").arg(QString(packet), QString::number(speedBps, 'f', 2));
-        emit dataReceived(message.toUtf8());
+    const qint64 size = txFile->size();
+    txMapping = size > 0 ? txFile->map(0, size) : nullptr;
+    if (txMapping) {
+        // Chunks are sliced straight out of the page cache; the file is never copied whole
+        beginTransmit(QByteArray::fromRawData(reinterpret_cast<const char *>(txMapping), size), size);
+    } else {
+        // Empty, or a file system that cannot map it: read it as the window opens
+        beginTransmit(QByteArray(), size);
+        attachTransmitDevice(txFile);
+    }
+    fillTransmitWindow();
+    finishTransmitIfDone();
+    return true;
+}
 
-        // Log if logging is enabled
-        if (loggingEnabled && logFile && logFile->isOpen()) {
-            QTextStream out(logFile);
-            out << message << "\n";
+bool FirmwareUART::sendDevice(QIODevice *device) {
+    if (!serialPort->isOpen() || isTransmitting() || !device || !device->isReadable()) {
+        return false;
+    }
+    // A sequential QFile would never report its end; see sendFile()
+    if (device->isSequential() && qobject_cast<QFileDevice *>(device)) {
+        return false;
+    }
+
+    beginTransmit(QByteArray(), device->isSequential() ? -1 : device->size() - device->pos());
+    attachTransmitDevice(device);
+    fillTransmitWindow();
+    finishTransmitIfDone();
+    return true;
+}
+
+bool FirmwareUART::writeData(const QByteArray &data) {
+    // Streams append to a buffer; a file or device transfer has no buffer to append to
+    if (!serialPort->isOpen() || txDevice || txMapping) {
+        return false;
+    }
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    if (!isTransmitting()) {
+        beginTransmit(QByteArray(), 0);
+    }
+    compactTransmitBuffer();
+    txData += data;
+    txTotal += data.size();
+    fillTransmitWindow();
+    return isTransmitting(); // A failed write resets the transfer
+}
+
+qint64 FirmwareUART::transmitPending() const {
+    return txData.size() - txWritten;
+}
+
+// QSerialPort otherwise writes from the event loop; callers that time their sends want
+// the bytes in the driver before they read the clock
+bool FirmwareUART::flushTransmit() {
+    return serialPort->isOpen() && serialPort->flush();
+}
+
+void FirmwareUART::beginTransmit(const QByteArray &data, qint64 total) {
+    txData = data;
+    txBase = 0;
+    txQueued = 0;
+    txWritten = 0;
+    txTotal = total;
+    txLastReportMs = 0;
+    txActive = true;
+    txTimer.start();
+}
+
+void FirmwareUART::attachTransmitDevice(QIODevice *device) {
+    txDevice = device;
+    txDeviceEnded = false;
+    if (device->isSequential()) {
+        // Pipes and sockets deliver data over time and end when their read channel finishes
+        connect(device, &QIODevice::readyRead, this, [this] {
+            fillTransmitWindow();
+            finishTransmitIfDone();
+        });
+        connect(device, &QIODevice::readChannelFinished, this, [this] {
+            txDeviceEnded = true;
+            fillTransmitWindow();
+            finishTransmitIfDone();
+        });
+    }
+}
+
+// Tops txData up from the streamed device; false if it has nothing more right now
+bool FirmwareUART::readFromTransmitDevice() {
+    if (!txDevice || txDeviceEnded) {
+        return false;
+    }
+    if (!txDevice->isOpen()) {
+        txDeviceEnded = true;
+        return false;
+    }
+
+    compactTransmitBuffer();
+    const QByteArray more = txDevice->read(DeviceReadBytes);
+    if (more.isEmpty()) {
+        // A random-access device that returns nothing is at its end (or failed)
+        if (!txDevice->isSequential()) {
+            txDeviceEnded = true;
         }
+        return false;
     }
+    txData += more;
+    return true;
+}
+
+// Drops the written prefix of a streamed transfer, so its buffer stays near one window
+void FirmwareUART::compactTransmitBuffer() {
+    if (txMapping || txWritten < CompactBytes) {
+        return;
+    }
+    txData.remove(0, txWritten);
+    txBase += txWritten;
+    txQueued -= txWritten;
+    txWritten = 0;
+}
 
+bool FirmwareUART::finishTransmitIfDone() {
+    const bool sourceDone = !txDevice || (txDeviceEnded && txDevice->bytesAvailable() <= 0);
+    if (!isTransmitting() || txWritten < txData.size() || !sourceDone) {
+        return false;
+    }
+    const bool wasFile = txDevice || txMapping;
+    reportTransmitProgress(true);
+    resetTransmit();
     emit dataSent();
+    if (wasFile) {
+        emit fileSent();
+    }
+    return true;
 }
 
-void FirmwareUART::receiveData() {
-    static QElapsedTimer timer;  // Timer for measuring speed
-    if (!timer.isValid()) {
-        timer.start();  // Start the timer if not already running
+void FirmwareUART::fillTransmitWindow() {
+    while (isTransmitting() && (txQueued - txWritten) < txWindowBytes) {
+        if (txQueued >= txData.size() && !readFromTransmitDevice()) {
+            break;
+        }
+        const qint64 room = txWindowBytes - (txQueued - txWritten);
+        const qint64 length = std::min({qint64(txChunkSize), room, qint64(txData.size()) - txQueued});
+        const QByteArray packet = txData.mid(txQueued, length);
+
+        const qint64 bytesQueued = serialPort->write(packet);
+        if (bytesQueued <= 0) {
+            qWarning() << "FirmwareUART: write failed:" << serialPort->errorString(); // Counted by handleError()
+            resetTransmit();
+            return;
+        }
+        txQueued += bytesQueued;
+
+        // Log if logging is enabled; this only queues the bytes for the writer thread
+        if (logWriter->isOpen()) {
+            logWriter->append(LogWriter::Direction::Sent, packet.left(bytesQueued));
+        }
+        if (captureStore) {
+            captureStore->append(CaptureStore::Direction::Sent, packet.constData(), bytesQueued, captureTimestampNs());
+        }
+    }
+}
+
+void FirmwareUART::handleBytesWritten(qint64 bytes) {
+    metrics.recordChunk(SerialMetrics::Transmit, bytes);
+    if (!isTransmitting()) {
+        return;
+    }
+
+    txWritten = qMin<qint64>(txWritten + bytes, txQueued);
+    fillTransmitWindow();
+    if (!finishTransmitIfDone()) {
+        reportTransmitProgress(false);
+    }
+}
+
+void FirmwareUART::reportTransmitProgress(bool force) {
+    const qint64 elapsedMs = txTimer.elapsed();
+    if (!force && elapsedMs - txLastReportMs < ProgressIntervalMs) {
+        return;
+    }
+    txLastReportMs = elapsedMs;
+    emit transmitProgress(txBase + txWritten, txTotal);
+}
+
+void FirmwareUART::cancelTransmit() {
+    if (!isTransmitting()) {
+        return;
+    }
+
+    // Drop whatever is still buffered in the port, not only what we have yet to queue
+    if (serialPort->isOpen()) {
+        serialPort->clear(QSerialPort::Output);
+    }
+    resetTransmit();
+    emit transmitCancelled();
+}
+
+void FirmwareUART::resetTransmit() {
+    txData.clear(); // Before unmapping: it may point into the mapping
+    txBase = 0;
+    txQueued = 0;
+    txWritten = 0;
+    txTotal = 0;
+    txActive = false;
+    txTimer.invalidate();
+
+    if (txDevice) {
+        disconnect(txDevice, nullptr, this, nullptr);
+        txDevice = nullptr;
     }
+    if (txFile) {
+        if (txMapping) {
+            txFile->unmap(txMapping);
+            txMapping = nullptr;
+        }
+        delete txFile;
+        txFile = nullptr;
+    }
+}
+
+bool FirmwareUART::isTransmitting() const {
+    return txActive;
+}
+
+void FirmwareUART::setFlowControl(QSerialPort::FlowControl control) {
+    flowControlMode = control;
+    if (serialPort->isOpen()) {
+        serialPort->setFlowControl(control);
+    }
+}
+
+QSerialPort::FlowControl FirmwareUART::flowControl() const {
+    return flowControlMode;
+}
+
+void FirmwareUART::setChunkSize(int bytes) {
+    txChunkSize = qMax(1, bytes);
+}
+
+int FirmwareUART::chunkSize() const {
+    return txChunkSize;
+}
 
+void FirmwareUART::setTransmitWindow(qint64 bytes) {
+    txWindowBytes = qMax<qint64>(1, bytes);
+}
+
+qint64 FirmwareUART::transmitWindow() const {
+    return txWindowBytes;
+}
+
+void FirmwareUART::receiveData() {
     QByteArray receivedData = serialPort->readAll();
     qint64 bytesReceived = receivedData.size();
 
     if (bytesReceived > 0) {
-        // Calculate receive speed
-        qint64 elapsedUs = timer.elapsed() * 1000;  // Elapsed time in microseconds
-        double speedBps = (elapsedUs > 0) ? (bytesReceived * 8 * 1e6) / elapsedUs : 0.0;
+        const qint64 receivedAtNs = captureTimestampNs();
+        metrics.recordChunk(SerialMetrics::Receive, bytesReceived);
 
-        emit receiveSpeedUpdated(speedBps);
+        // Triggers go first so that an automatic response leaves as early as possible
+        if (rxTriggers) {
+            rxTriggers->feed(receivedData, receivedAtNs);
+        }
 
-        QString message = QString("Received data: %1 - Speed: %2 bps").arg(QString(receivedData), QString::number(speedBps, 'f', 2));
+        if (rxBuffer) {
+            // I/O-thread mode: hand the raw bytes to the GUI through the ring
+            pushToReceiveBuffer(receivedData);
+        } else {
+            emit dataReceived(receivedData);
+        }
 
-        // Print to console
-        emit dataReceived(message.toUtf8());
+        if (rxDecoder) {
+            rxDecoder->feed(receivedData);
+        }
+
+        if (rxTelemetry) {
+            rxTelemetry->feed(receivedData, monotonicTimestampNs());
+        }
 
-        // Log received data if logging is enabled
-        if (loggingEnabled && logFile && logFile->isOpen()) {
-            QTextStream out(logFile);
-            out << message << "\n";
+        if (captureStore) {
+            captureStore->append(CaptureStore::Direction::Received, receivedData.constData(), bytesReceived,
+                                 receivedAtNs);
         }
 
-        // Reset timer for next chunk
-        timer.restart();
+        // Log the raw received bytes if logging is enabled
+        if (logWriter->isOpen()) {
+            logWriter->append(LogWriter::Direction::Received, receivedData);
+        }
     }
 }
 
-bool FirmwareUART::setupLogFile(const QString &filePath) {
-    closeLogFile(); // Close any existing log file
-    logFile = new QFile(filePath);
-    if (logFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        loggingEnabled = true;
-        return true;
-    } else {
-        delete logFile;
-        logFile = nullptr;
-        loggingEnabled = false;  // Make sure logging is disabled if the file didn't open
-        return false;
+void FirmwareUART::handleError(QSerialPort::SerialPortError error) {
+    if (error != QSerialPort::NoError) {
+        metrics.recordError();
+    }
+    // The device went away (e.g. a USB adapter was unplugged); nothing more will get through
+    if (error == QSerialPort::ResourceError && serialPort->isOpen()) {
+        disconnectFromPort();
     }
 }
 
-// Close and delete the log file if it exists
-void FirmwareUART::closeLogFile() {
-    if (logFile && logFile->isOpen()) {
-        logFile->close();
+void FirmwareUART::handlePortRemoved(const QString &portName) {
+    if (serialPort->isOpen() && serialPort->portName() == portName) {
+        disconnectFromPort();
     }
-    delete logFile;
-    logFile = nullptr;
-    loggingEnabled = false;
+}
+
+void FirmwareUART::pushToReceiveBuffer(const QByteArray &data) {
+    const qsizetype accepted = rxBuffer->write(data.constData(), data.size());
+    if (accepted < data.size()) {
+        // The GUI has fallen behind; drop the excess rather than stall the port
+        const quint64 dropped = quint64(data.size() - accepted);
+        rxOverrunBytes += dropped;
+        ++rxOverrunCount;
+        metrics.recordOverrun(dropped);
+    }
+
+    // Only one wake-up is in flight at a time; the consumer re-arms before draining
+    if (accepted > 0 && !rxNotifyPending.exchange(true)) {
+        emit receiveBufferReadyRead();
+    }
+}
+
+void FirmwareUART::setFrameDecoder(FrameDecoder *decoder) {
+    rxDecoder = decoder;
+    if (rxDecoder) {
+        // The view is only valid during the callback and the signal may be queued, so this is
+        // the one copy each frame costs
+        rxDecoder->setFrameHandler([this](QByteArrayView frame) {
+            emit frameReceived(frame.toByteArray());
+        });
+    }
+}
+
+FrameDecoder *FirmwareUART::frameDecoder() const {
+    return rxDecoder;
+}
+
+void FirmwareUART::setTriggerEngine(TriggerEngine *engine) {
+    rxTriggers = engine;
+    if (rxTriggers) {
+        rxTriggers->setMatchHandler([this](int id, qint64 offset, qint64 timestampNs) {
+            const TriggerEngine::Trigger &trigger = rxTriggers->trigger(id);
+            if (trigger.action == TriggerEngine::Action::Respond) {
+                writeData(trigger.response); // Fails, and is skipped, during a file transfer
+            }
+            emit triggerMatched(id, offset, timestampNs);
+        });
+    }
+}
+
+TriggerEngine *FirmwareUART::triggerEngine() const {
+    return rxTriggers;
+}
+
+void FirmwareUART::setTelemetryParser(TelemetryParser *parser) {
+    rxTelemetry = parser;
+}
+
+TelemetryParser *FirmwareUART::telemetryParser() const {
+    return rxTelemetry;
+}
+
+void FirmwareUART::setCaptureStore(CaptureStore *store) {
+    captureStore = store;
+}
+
+void FirmwareUART::setReceiveBuffer(SpscRingBuffer *buffer) {
+    rxBuffer = buffer;
+}
+
+void FirmwareUART::rearmReceiveNotification() {
+    rxNotifyPending = false;
+}
+
+quint64 FirmwareUART::receiveOverrunBytes() const {
+    return rxOverrunBytes.load();
+}
+
+quint64 FirmwareUART::receiveOverrunCount() const {
+    return rxOverrunCount.load();
+}
+
+SerialMetrics::Snapshot FirmwareUART::metricsSnapshot() const {
+    SerialMetrics::Snapshot snapshot = metrics.snapshot();
+    snapshot.logDroppedBytes = logWriter->bytesDropped();
+    return snapshot;
+}
+
+bool FirmwareUART::setupLogFile(const QString &filePath, LogWriter::Format format) {
+    // open() closes any existing log file first
+    return logWriter->open(filePath, format);
+}
+
+// Flush whatever is still queued and close the log file if it exists
+void FirmwareUART::closeLogFile() {
+    logWriter->close();
+}
+
+void FirmwareUART::setLogRotation(qint64 maxFileBytes, qint64 maxFileAgeSecs) {
+    logWriter->setRotation(maxFileBytes, maxFileAgeSecs);
+}
+
+quint64 FirmwareUART::logBytesQueued() const {
+    return logWriter->bytesQueued();
+}
+
+quint64 FirmwareUART::logBytesWritten() const {
+    return logWriter->bytesWritten();
 }
 
 void FirmwareUART::setDataToSend(const QString& data) {
+    dataToSend = data.toUtf8();
+}
+
+void FirmwareUART::setDataToSend(const QByteArray& data) {
     dataToSend = data;
 }
 
@@ -4,7 +4,18 @@
 #include <QObject>
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QTimer>
+#include "library/capturestore.h"
+#include "library/framedecoder.h"
+#include "library/logwriter.h"
+#include "library/serialmetrics.h"
+#include "library/telemetryparser.h"
+#include "library/triggerengine.h"
+#include <atomic>
+
+class SpscRingBuffer;
 
 // The FirmwareUART class handles UART communication, logging, and data transmission
 class FirmwareUART : public QObject
@@ -22,28 +33,145 @@ public:
 
     // Data and logging functions
     void sendData();
-    bool setupLogFile(const QString &filePath);
+    bool sendFile(const QString &filePath);   // Regular files only; memory-mapped when possible
+    bool sendDevice(QIODevice *device);       // Streamed as the window opens; not owned, same thread.
+                                              // Sequential devices must signal readChannelFinished()
+    bool setupLogFile(const QString &filePath, LogWriter::Format format = LogWriter::Format::Text);
     void closeLogFile();
-    void setDataToSend(const QString& data);
+    void setLogRotation(qint64 maxFileBytes, qint64 maxFileAgeSecs); // 0 disables a limit; any thread
+    quint64 logBytesQueued() const;           // Thread-safe log writer statistics
+    quint64 logBytesWritten() const;
+    void setDataToSend(const QString& data);      // Sent as UTF-8
+    void setDataToSend(const QByteArray& data);   // Sent as-is, for binary payloads
+
+    // Applied on connect, or immediately if already connected. RTS/CTS and XON/XOFF pacing
+    // is done by the driver; a paused line simply stops bytesWritten and so the window.
+    // Software flow control reserves 0x11/0x13, so it only suits text or escaped data.
+    void setFlowControl(QSerialPort::FlowControl control);
+    QSerialPort::FlowControl flowControl() const;
+
+    // Transmit pipeline tuning
+    void setChunkSize(int bytes);             // Bytes handed to the port per write() call
+    int chunkSize() const;
+    void setTransmitWindow(qint64 bytes);     // Bytes allowed in flight before waiting for bytesWritten
+    qint64 transmitWindow() const;
+    bool isTransmitting() const;
+
+    // Streaming transmit: appends to the transfer in progress, or starts one. Used by
+    // ReplayEngine and WindowedUpload; dataSent() is emitted each time everything queued
+    // has been written, so wait for fileSent() to see a file through. Fails while a file or
+    // device transfer is running.
+    bool writeData(const QByteArray &data);
+    qint64 transmitPending() const;           // Bytes queued but not yet reported written
+    bool flushTransmit();                     // Hand queued bytes to the driver now, without blocking
+
+    // I/O-thread mode: received bytes go into the ring instead of dataReceived().
+    // The ring is not owned; set it before moving this object to its thread.
+    void setReceiveBuffer(SpscRingBuffer *buffer);
+    void rearmReceiveNotification();          // Consumer calls this before draining the ring
+    quint64 receiveOverrunBytes() const;      // Bytes dropped because the ring was full
+    quint64 receiveOverrunCount() const;      // Reads that dropped at least one byte
+
+    // Optional framing stage: received bytes are also fed to the decoder, and each
+    // valid frame is emitted as frameReceived(). Not owned; set before moving threads.
+    void setFrameDecoder(FrameDecoder *decoder);
+    FrameDecoder *frameDecoder() const;
+
+    // Optional trigger stage: received bytes are fed to the compiled engine before anything
+    // else, Respond triggers write their response from this thread, and every match is
+    // emitted as triggerMatched(). Not owned; set it before moving threads, or on this
+    // object's thread to swap engines while running.
+    void setTriggerEngine(TriggerEngine *engine);
+    TriggerEngine *triggerEngine() const;
+
+    // Optional telemetry stage: received lines are parsed into the parser's store on this
+    // thread, so plotting costs the GUI only the redraw. Not owned; set it before moving
+    // threads, or on this object's thread to switch parsing on and off while running.
+    void setTelemetryParser(TelemetryParser *parser);
+    TelemetryParser *telemetryParser() const;
+
+    // Optional capture of every byte sent and received, for the hex view. Not owned.
+    void setCaptureStore(CaptureStore *store);
+
+    // Throughput, chunk and error statistics for the current connection, sampled on a timer.
+    // Thread-safe; poll this instead of reacting to every chunk.
+    SerialMetrics::Snapshot metricsSnapshot() const;
+
+public slots:
+    void cancelTransmit(); // Abort the current transfer and drop queued output
+    void handlePortRemoved(const QString &portName); // Disconnect if it is our port; from PortMonitor
 
 signals:
-    // Signals for updating UI with speed and connection status
-    void transmissionSpeedUpdated(double speedBps);
-    void receiveSpeedUpdated(double speedBps);
-    void dataReceived(QByteArray data);
+    // Signals for updating UI with transfer and connection status
+    void transmitProgress(qint64 bytesSent, qint64 bytesTotal);
+    void dataReceived(QByteArray data);       // Raw bytes, when no receive ring is attached
+    void receiveBufferReadyRead();            // Ring went from drained to holding data
+    void frameReceived(QByteArray frame);     // Decoded payload, checksum already verified; a copy
+    void triggerMatched(int trigger, qint64 offset, qint64 timestampNs); // Offset in the receive stream
     void dataSent();
+    void fileSent();                          // A sendFile() or sendDevice() transfer has been written
+    void transmitCancelled();
     void connectionStatusChanged(bool isConnected);
+    void logWriteError(QString message);      // The log writer failed to write or rotate; logging may have stopped
 
 private slots:
     void receiveData(); // Slot for receiving incoming data
+    void handleBytesWritten(qint64 bytes); // Slot for draining the transmit window
+    void handleError(QSerialPort::SerialPortError error);
 
 private:
+    void beginTransmit(const QByteArray &data, qint64 total);
+    void attachTransmitDevice(QIODevice *device);
+    bool readFromTransmitDevice();
+    void compactTransmitBuffer();
+    bool finishTransmitIfDone();
+    void fillTransmitWindow();
+    void reportTransmitProgress(bool force);
+    void resetTransmit();
+    void pushToReceiveBuffer(const QByteArray &data);
+
     QSerialPort *serialPort;
-    QFile *logFile;
-    bool loggingEnabled;
-    QString dataToSend;
+    std::atomic<bool> connected;              // Readable from any thread, unlike serialPort
+    LogWriter *logWriter;                     // Writes on its own thread; never blocks the port
+    QByteArray dataToSend;
+    QSerialPort::FlowControl flowControlMode;
+
+    // Transmit pipeline state. txData holds the part of the transfer not yet written:
+    // all of it for a buffer or a mapped file, a window's worth for streamed sources.
+    QByteArray txData;
+    qint64 txBase;            // Transfer offset of txData[0]; the bytes before it are written and dropped
+    qint64 txQueued;          // Bytes of txData handed to the port so far
+    qint64 txWritten;         // Bytes of txData the port reported as written
+    qint64 txTotal;           // Size of the transfer, -1 while unknown
+    QElapsedTimer txTimer;    // Started when the transfer begins
+    qint64 txLastReportMs;    // Time of the last progress signal
+    bool txActive;
+    int txChunkSize;
+    qint64 txWindowBytes;
+    QFile *txFile;            // Opened by sendFile()
+    uchar *txMapping;         // txFile's mapping, which txData points into
+    QIODevice *txDevice;      // Streamed source, read as the window opens
+    bool txDeviceEnded;
+
+    // Receive ring state
+    SpscRingBuffer *rxBuffer;
+    FrameDecoder *rxDecoder;
+    TriggerEngine *rxTriggers;
+    TelemetryParser *rxTelemetry;
+    CaptureStore *captureStore;
+    std::atomic<bool> rxNotifyPending;        // Set once per wake-up, cleared by the consumer
+    std::atomic<quint64> rxOverrunBytes;
+    std::atomic<quint64> rxOverrunCount;
+
+    SerialMetrics metrics;
+    QTimer *metricsTimer;                     // Drives metrics.sample() while connected
 
-    static constexpr int PacketSize = 32; // Size of data packets to be sent
+    static constexpr int DefaultChunkSize = 32;         // Size of data packets to be sent
+    static constexpr qint64 DefaultWindowBytes = 4096;  // Roughly one kernel tty buffer
+    static constexpr qint64 ProgressIntervalMs = 100;   // Limit progress signals to 10 per second
+    static constexpr int MetricsSampleMs = 100;         // Throughput sampling period
+    static constexpr qint64 DeviceReadBytes = 64 * 1024; // Read-ahead from a streamed source
+    static constexpr qint64 CompactBytes = 64 * 1024;    // Written bytes kept before compacting txData
 };
 
 #endif // FIRMWAREUART_H
@@ -0,0 +1,365 @@
+#include "library/framedecoder.h"
+#include "library/crc.h"
+#include <QtEndian>
+#include <cstring>
+
+static constexpr char SlipEnd = char(0xC0);
+static constexpr char SlipEsc = char(0xDB);
+static constexpr char SlipEscEnd = char(0xDC);
+static constexpr char SlipEscEsc = char(0xDD);
+
+FrameDecoder::FrameDecoder(Checksum checksum, qsizetype maxFrameBytes)
+    : frameChecksum(checksum), frameLimit(qMax<qsizetype>(1, maxFrameBytes)) {}
+
+void FrameDecoder::setFrameHandler(FrameHandler frameHandler) {
+    handler = std::move(frameHandler);
+}
+
+FrameDecoder::Checksum FrameDecoder::checksum() const {
+    return frameChecksum;
+}
+
+qsizetype FrameDecoder::maxFrameBytes() const {
+    return frameLimit;
+}
+
+void FrameDecoder::reset() {
+    pending.clear();
+}
+
+FrameDecoder::Stats FrameDecoder::stats() const {
+    Stats result;
+    result.frames = frameCount.load(std::memory_order_relaxed);
+    result.bytes = byteCount.load(std::memory_order_relaxed);
+    result.checksumErrors = checksumErrorCount.load(std::memory_order_relaxed);
+    result.encodingErrors = encodingErrorCount.load(std::memory_order_relaxed);
+    result.oversizeErrors = oversizeErrorCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+// False if the frame failed its checksum or was too short to carry one
+bool FrameDecoder::deliver(QByteArrayView frame) {
+    qsizetype payloadSize = frame.size();
+    if (frameChecksum == Checksum::Crc16) {
+        payloadSize -= 2;
+        if (payloadSize < 0) {
+            countEncodingError();
+            return false;
+        }
+        if (crc16Ccitt(frame.data(), payloadSize) != qFromLittleEndian<quint16>(frame.data() + payloadSize)) {
+            checksumErrorCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } else if (frameChecksum == Checksum::Crc32) {
+        payloadSize -= 4;
+        if (payloadSize < 0) {
+            countEncodingError();
+            return false;
+        }
+        if (crc32(frame.data(), payloadSize) != qFromLittleEndian<quint32>(frame.data() + payloadSize)) {
+            checksumErrorCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    frameCount.fetch_add(1, std::memory_order_relaxed);
+    byteCount.fetch_add(quint64(payloadSize), std::memory_order_relaxed);
+    if (handler) {
+        handler(frame.first(payloadSize));
+    }
+    return true;
+}
+
+void FrameDecoder::countEncodingError() {
+    encodingErrorCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameDecoder::countOversizeError() {
+    oversizeErrorCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+QByteArray FrameDecoder::withChecksum(QByteArrayView payload) const {
+    QByteArray frame(payload.data(), payload.size());
+    if (frameChecksum == Checksum::Crc16) {
+        char trailer[2];
+        qToLittleEndian<quint16>(crc16Ccitt(payload.data(), payload.size()), trailer);
+        frame.append(trailer, sizeof(trailer));
+    } else if (frameChecksum == Checksum::Crc32) {
+        char trailer[4];
+        qToLittleEndian<quint32>(crc32(payload.data(), payload.size()), trailer);
+        frame.append(trailer, sizeof(trailer));
+    }
+    return frame;
+}
+
+// ---- COBS ----
+
+void CobsFrameDecoder::feed(QByteArrayView data) {
+    const char *cursor = data.data();
+    const char *end = cursor + data.size();
+    while (cursor < end) {
+        // memchr is vectorised by the C library, so delimiter scanning runs at memory speed
+        const char *delimiter = static_cast<const char *>(std::memchr(cursor, 0, size_t(end - cursor)));
+        if (!delimiter) {
+            if (!discarding) {
+                pending.append(cursor, end - cursor);
+                if (pending.size() > maxFrameBytes()) {
+                    countOversizeError();
+                    pending.clear();
+                    discarding = true;
+                }
+            }
+            return;
+        }
+
+        const qsizetype length = delimiter - cursor;
+        if (discarding) {
+            discarding = false;
+        } else if (pending.isEmpty()) {
+            if (length > maxFrameBytes()) {
+                countOversizeError();
+            } else if (length > 0) {
+                decodeFrame(QByteArrayView(cursor, length));
+            }
+        } else {
+            pending.append(cursor, length);
+            if (pending.size() > maxFrameBytes()) {
+                countOversizeError();
+            } else {
+                decodeFrame(pending);
+            }
+            pending.clear();
+        }
+        cursor = delimiter + 1;
+    }
+}
+
+void CobsFrameDecoder::reset() {
+    FrameDecoder::reset();
+    discarding = false;
+}
+
+void CobsFrameDecoder::decodeFrame(QByteArrayView encoded) {
+    decoded.resize(encoded.size());
+    char *out = decoded.data();
+    const uchar *in = reinterpret_cast<const uchar *>(encoded.data());
+    const uchar *end = in + encoded.size();
+
+    while (in < end) {
+        const int code = *in++;
+        if (code == 0 || code - 1 > end - in) {
+            countEncodingError();
+            return;
+        }
+        std::memcpy(out, in, size_t(code - 1));
+        out += code - 1;
+        in += code - 1;
+        // A full 254-byte block, or the final block, carries no implied zero
+        if (code != 0xFF && in < end) {
+            *out++ = 0;
+        }
+    }
+    deliver(QByteArrayView(decoded.constData(), out - decoded.constData()));
+}
+
+QByteArray CobsFrameDecoder::encode(QByteArrayView payload) const {
+    const QByteArray frame = withChecksum(payload);
+    QByteArray encoded;
+    encoded.reserve(frame.size() + frame.size() / 254 + 2);
+
+    qsizetype codeIndex = 0;
+    encoded.append(char(1));
+    for (const char byte : frame) {
+        if (byte == 0) {
+            codeIndex = encoded.size();
+            encoded.append(char(1));
+            continue;
+        }
+        encoded.append(byte);
+        if (++encoded[codeIndex] == char(0xFF)) {
+            codeIndex = encoded.size();
+            encoded.append(char(1));
+        }
+    }
+    encoded.append(char(0));
+    return encoded;
+}
+
+// ---- SLIP ----
+
+void SlipFrameDecoder::feed(QByteArrayView data) {
+    const char *cursor = data.data();
+    const char *end = cursor + data.size();
+    while (cursor < end) {
+        const char *delimiter = static_cast<const char *>(std::memchr(cursor, SlipEnd, size_t(end - cursor)));
+        if (!delimiter) {
+            if (!discarding) {
+                pending.append(cursor, end - cursor);
+                if (pending.size() > maxFrameBytes()) {
+                    countOversizeError();
+                    pending.clear();
+                    discarding = true;
+                }
+            }
+            return;
+        }
+
+        const qsizetype length = delimiter - cursor;
+        if (discarding) {
+            discarding = false;
+        } else if (pending.isEmpty()) {
+            // Empty frames come from the optional leading END and are not errors
+            if (length > maxFrameBytes()) {
+                countOversizeError();
+            } else if (length > 0) {
+                decodeFrame(QByteArrayView(cursor, length));
+            }
+        } else {
+            pending.append(cursor, length);
+            if (pending.size() > maxFrameBytes()) {
+                countOversizeError();
+            } else {
+                decodeFrame(pending);
+            }
+            pending.clear();
+        }
+        cursor = delimiter + 1;
+    }
+}
+
+void SlipFrameDecoder::reset() {
+    FrameDecoder::reset();
+    discarding = false;
+}
+
+void SlipFrameDecoder::decodeFrame(QByteArrayView encoded) {
+    // Most frames contain no escapes and can be handed on without a copy
+    const char *escape = static_cast<const char *>(std::memchr(encoded.data(), SlipEsc, size_t(encoded.size())));
+    if (!escape) {
+        deliver(encoded);
+        return;
+    }
+
+    decoded.resize(encoded.size());
+    char *out = decoded.data();
+    const char *in = encoded.data();
+    const char *end = in + encoded.size();
+    while (escape) {
+        const qsizetype plain = escape - in;
+        std::memcpy(out, in, size_t(plain));
+        out += plain;
+        in = escape + 1;
+        if (in == end || (*in != SlipEscEnd && *in != SlipEscEsc)) {
+            countEncodingError();
+            return;
+        }
+        *out++ = (*in == SlipEscEnd) ? SlipEnd : SlipEsc;
+        ++in;
+        escape = static_cast<const char *>(std::memchr(in, SlipEsc, size_t(end - in)));
+    }
+    std::memcpy(out, in, size_t(end - in));
+    out += end - in;
+    deliver(QByteArrayView(decoded.constData(), out - decoded.constData()));
+}
+
+QByteArray SlipFrameDecoder::encode(QByteArrayView payload) const {
+    const QByteArray frame = withChecksum(payload);
+    QByteArray encoded;
+    encoded.reserve(frame.size() + 2);
+    encoded.append(SlipEnd); // Flushes any line noise on the receiving side
+    for (const char byte : frame) {
+        if (byte == SlipEnd) {
+            encoded.append(SlipEsc).append(SlipEscEnd);
+        } else if (byte == SlipEsc) {
+            encoded.append(SlipEsc).append(SlipEscEsc);
+        } else {
+            encoded.append(byte);
+        }
+    }
+    encoded.append(SlipEnd);
+    return encoded;
+}
+
+// ---- Length-prefixed ----
+
+LengthPrefixedFrameDecoder::LengthPrefixedFrameDecoder(int lengthBytes, Checksum checksum, qsizetype maxFrameBytes)
+    : FrameDecoder(checksum, maxFrameBytes),
+      lengthBytes((lengthBytes == 1 || lengthBytes == 4) ? lengthBytes : 2) {}
+
+quint32 LengthPrefixedFrameDecoder::readLength(const char *data) const {
+    switch (lengthBytes) {
+    case 1:
+        return uchar(data[0]);
+    case 4:
+        return qFromLittleEndian<quint32>(data);
+    default:
+        return qFromLittleEndian<quint16>(data);
+    }
+}
+
+qsizetype LengthPrefixedFrameDecoder::parse(const char *data, qsizetype length) {
+    qsizetype offset = 0;
+    while (length - offset >= lengthBytes) {
+        const quint32 frameLength = readLength(data + offset);
+        if (frameLength > quint64(maxFrameBytes())) {
+            countOversizeError();
+            ++offset; // No delimiter to skip to; try the next byte as a length
+            continue;
+        }
+        if (length - offset - lengthBytes < qsizetype(frameLength)) {
+            break;
+        }
+        if (!deliver(QByteArrayView(data + offset + lengthBytes, qsizetype(frameLength)))) {
+            ++offset; // The length was probably noise too; it may have swallowed good frames
+            continue;
+        }
+        offset += lengthBytes + qsizetype(frameLength);
+    }
+    return offset;
+}
+
+qsizetype LengthPrefixedFrameDecoder::bytesNeeded() const {
+    if (pending.size() < lengthBytes) {
+        return lengthBytes - pending.size();
+    }
+    const quint32 frameLength = readLength(pending.constData());
+    if (frameLength > quint64(maxFrameBytes())) {
+        return 0; // parse() will skip past it
+    }
+    return lengthBytes + qsizetype(frameLength) - pending.size();
+}
+
+void LengthPrefixedFrameDecoder::feed(QByteArrayView data) {
+    const char *cursor = data.data();
+    qsizetype remaining = data.size();
+
+    // Finish the frame left over from the last call by copying in only what it still needs,
+    // so the rest of this buffer can be parsed in place
+    while (!pending.isEmpty() && remaining > 0) {
+        const qsizetype take = qMin(bytesNeeded(), remaining);
+        pending.append(cursor, take);
+        cursor += take;
+        remaining -= take;
+        pending.remove(0, parse(pending.constData(), pending.size()));
+    }
+
+    const qsizetype consumed = parse(cursor, remaining);
+    pending.append(cursor + consumed, remaining - consumed);
+}
+
+QByteArray LengthPrefixedFrameDecoder::encode(QByteArrayView payload) const {
+    const QByteArray frame = withChecksum(payload);
+    char header[4];
+    switch (lengthBytes) {
+    case 1:
+        header[0] = char(frame.size());
+        break;
+    case 4:
+        qToLittleEndian<quint32>(quint32(frame.size()), header);
+        break;
+    default:
+        qToLittleEndian<quint16>(quint16(frame.size()), header);
+        break;
+    }
+    return QByteArray(header, lengthBytes) + frame;
+}
@@ -0,0 +1,129 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <atomic>
+#include <functional>
+
+// The FrameDecoder classes turn a raw receive stream into whole frames.
+// feed() accepts data in whatever pieces readyRead delivers and keeps partial frames
+// across calls. Each decoded frame has its checksum verified and stripped, then goes
+// to the frame handler as a view, only valid during the call. SLIP and length-prefixed
+// frames that arrived in one piece and needed no unescaping point straight into the fed
+// data; COBS frames, escaped frames and frames split across reads are decoded into a
+// buffer the decoder reuses, so a steady stream is decoded without allocating. A handler
+// that keeps a frame beyond the call has to copy it.
+class FrameDecoder
+{
+public:
+    enum class Checksum {
+        None,
+        Crc16,  // CRC-16/CCITT-FALSE, 2 bytes little-endian after the payload
+        Crc32   // CRC-32 (IEEE), 4 bytes little-endian after the payload
+    };
+
+    struct Stats {
+        quint64 frames = 0;          // Frames delivered to the handler
+        quint64 bytes = 0;           // Payload bytes delivered
+        quint64 checksumErrors = 0;
+        quint64 encodingErrors = 0;  // Invalid escape/code bytes or frames shorter than the checksum
+        quint64 oversizeErrors = 0;  // Frames longer than maxFrameBytes(), dropped
+        quint64 errors() const { return checksumErrors + encodingErrors + oversizeErrors; }
+    };
+
+    using FrameHandler = std::function<void(QByteArrayView frame)>;
+
+    explicit FrameDecoder(Checksum checksum = Checksum::None, qsizetype maxFrameBytes = DefaultMaxFrameBytes);
+    virtual ~FrameDecoder() = default;
+
+    void setFrameHandler(FrameHandler handler);
+    Checksum checksum() const;
+    qsizetype maxFrameBytes() const;  // Limit on the encoded frame, excluding delimiters or length field
+
+    virtual void feed(QByteArrayView data) = 0;
+    virtual void reset();             // Forget any partial frame, e.g. after reconnecting
+
+    // Frames a payload the way feed() expects it, checksum included; useful for transmit and tests
+    virtual QByteArray encode(QByteArrayView payload) const = 0;
+
+    Stats stats() const;              // Thread-safe
+
+    static constexpr qsizetype DefaultMaxFrameBytes = 64 * 1024;
+
+protected:
+    bool deliver(QByteArrayView frame); // Verifies and strips the checksum, then calls the handler
+    void countEncodingError();
+    void countOversizeError();
+    QByteArray withChecksum(QByteArrayView payload) const;
+
+    QByteArray pending; // Start of a frame whose end has not arrived yet
+
+private:
+    FrameHandler handler;
+    Checksum frameChecksum;
+    qsizetype frameLimit;
+
+    std::atomic<quint64> frameCount {0};
+    std::atomic<quint64> byteCount {0};
+    std::atomic<quint64> checksumErrorCount {0};
+    std::atomic<quint64> encodingErrorCount {0};
+    std::atomic<quint64> oversizeErrorCount {0};
+};
+
+// Consistent Overhead Byte Stuffing: frames end with 0x00, which never occurs inside them
+class CobsFrameDecoder : public FrameDecoder
+{
+public:
+    using FrameDecoder::FrameDecoder;
+
+    void feed(QByteArrayView data) override;
+    void reset() override;
+    QByteArray encode(QByteArrayView payload) const override;
+
+private:
+    void decodeFrame(QByteArrayView encoded);
+
+    QByteArray decoded;  // Reused output buffer
+    bool discarding = false; // Dropping the rest of an oversize frame
+};
+
+// RFC 1055 SLIP: frames end with END (0xC0); END and ESC inside a frame are escaped
+class SlipFrameDecoder : public FrameDecoder
+{
+public:
+    using FrameDecoder::FrameDecoder;
+
+    void feed(QByteArrayView data) override;
+    void reset() override;
+    QByteArray encode(QByteArrayView payload) const override;
+
+private:
+    void decodeFrame(QByteArrayView encoded);
+
+    QByteArray decoded;
+    bool discarding = false;
+};
+
+// Each frame is preceded by its length (payload plus checksum) as an unsigned
+// little-endian integer of 1, 2 or 4 bytes. There is no delimiter, so after an
+// oversize length or a frame that fails its checksum the decoder slides forward one
+// byte at a time to resynchronise, rather than trusting the length it just read.
+class LengthPrefixedFrameDecoder : public FrameDecoder
+{
+public:
+    explicit LengthPrefixedFrameDecoder(int lengthBytes = 2, Checksum checksum = Checksum::None,
+                                        qsizetype maxFrameBytes = DefaultMaxFrameBytes);
+
+    void feed(QByteArrayView data) override;
+    QByteArray encode(QByteArrayView payload) const override;
+
+private:
+    qsizetype parse(const char *data, qsizetype length); // Returns bytes consumed
+    qsizetype bytesNeeded() const;                       // To complete the frame started in pending
+    quint32 readLength(const char *data) const;
+
+    int lengthBytes;
+};
+
+#endif // FRAMEDECODER_H
@@ -0,0 +1,134 @@
+#include "library/hexview.h"
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+#include <climits>
+
+static const QColor SentColor(0, 102, 204);
+
+HexView::HexView(QWidget *parent)
+    : QAbstractScrollArea(parent), store(nullptr), knownBytes(0), markedOffset(-1) {
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    verticalScrollBar()->setSingleStep(3);
+}
+
+void HexView::setStore(const CaptureStore *captureStore) {
+    store = captureStore;
+    knownBytes = 0;
+    markedOffset = -1;
+    refresh();
+}
+
+void HexView::refresh() {
+    const qint64 bytes = store ? store->size() : 0;
+    if (bytes == knownBytes) {
+        return;
+    }
+
+    // Keep following new data only if the view was already at the end
+    QScrollBar *scrollBar = verticalScrollBar();
+    const bool followTail = scrollBar->value() == scrollBar->maximum();
+    if (bytes < knownBytes) {
+        markedOffset = -1; // The store was cleared
+    }
+    knownBytes = bytes;
+    updateScrollRange();
+    if (followTail) {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+    viewport()->update();
+}
+
+void HexView::scrollToOffset(qint64 offset) {
+    if (offset < 0 || offset >= knownBytes) {
+        return;
+    }
+    markedOffset = offset;
+    verticalScrollBar()->setValue(int(offset / BytesPerRow));
+    viewport()->update();
+}
+
+int HexView::visibleRows() const {
+    return qMax(1, viewport()->height() / fontMetrics().height());
+}
+
+void HexView::updateScrollRange() {
+    const qint64 rows = (knownBytes + BytesPerRow - 1) / BytesPerRow;
+    const int pageRows = visibleRows();
+    verticalScrollBar()->setPageStep(pageRows);
+    verticalScrollBar()->setRange(0, int(qMin<qint64>(qMax<qint64>(0, rows - pageRows), INT_MAX)));
+
+    // Offset, time, hex and ASCII columns, each followed by a margin
+    const int columns = 10 + 12 + BytesPerRow * 3 + BytesPerRow + 4 * MarginChars;
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, columns * fontMetrics().horizontalAdvance('0') - viewport()->width()));
+}
+
+void HexView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange();
+}
+
+void HexView::paintEvent(QPaintEvent *) {
+    if (!store) {
+        return;
+    }
+
+    QPainter painter(viewport());
+    const QFontMetrics metrics = fontMetrics();
+    const int charWidth = metrics.horizontalAdvance('0');
+    const int lineHeight = metrics.height();
+    const QColor receivedColor = palette().color(QPalette::Text);
+    const QColor dimColor = palette().color(QPalette::PlaceholderText);
+
+    const int offsetX = MarginChars * charWidth - horizontalScrollBar()->value();
+    const int timeX = offsetX + (10 + MarginChars) * charWidth;
+    const int hexX = timeX + (12 + MarginChars) * charWidth;
+    const int asciiX = hexX + (BytesPerRow * 3 + MarginChars) * charWidth;
+
+    char bytes[BytesPerRow];
+    CaptureStore::Direction directions[BytesPerRow];
+    const qint64 firstRow = verticalScrollBar()->value();
+    for (int line = 0; line * lineHeight < viewport()->height(); ++line) {
+        const qint64 offset = (firstRow + line) * BytesPerRow;
+        if (offset >= knownBytes) {
+            break;
+        }
+        const qsizetype count = store->read(offset, bytes, qsizetype(qMin<qint64>(BytesPerRow, knownBytes - offset)),
+                                            directions);
+        const int top = line * lineHeight;
+        const int baseline = top + metrics.ascent();
+
+        if (markedOffset >= offset && markedOffset < offset + count) {
+            const int column = int(markedOffset - offset);
+            painter.fillRect(hexX + column * 3 * charWidth, top, 2 * charWidth, lineHeight, palette().highlight());
+            painter.fillRect(asciiX + column * charWidth, top, charWidth, lineHeight, palette().highlight());
+        }
+
+        painter.setPen(dimColor);
+        painter.drawText(offsetX, baseline, QString("%1").arg(offset, 10, 16, QChar('0')).toUpper());
+        const qint64 timestampMs = store->timestampAt(offset) / 1000000;
+        painter.drawText(timeX, baseline, QDateTime::fromMSecsSinceEpoch(timestampMs).toString("hh:mm:ss.zzz"));
+
+        // One drawText per run of same-direction bytes rather than one per byte
+        for (qsizetype start = 0; start < count;) {
+            qsizetype end = start + 1;
+            while (end < count && directions[end] == directions[start]) {
+                ++end;
+            }
+            QString hex;
+            QString ascii;
+            for (qsizetype i = start; i < end; ++i) {
+                const uchar byte = uchar(bytes[i]);
+                hex += QString("%1 ").arg(uint(byte), 2, 16, QChar('0')).toUpper();
+                ascii += (byte >= 0x20 && byte < 0x7F) ? QChar(byte) : QChar('.');
+            }
+            painter.setPen(directions[start] == CaptureStore::Direction::Sent ? SentColor : receivedColor);
+            painter.drawText(hexX + int(start) * 3 * charWidth, baseline, hex);
+            painter.drawText(asciiX + int(start) * charWidth, baseline, ascii);
+            start = end;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef HEXVIEW_H
+#define HEXVIEW_H
+
+#include <QAbstractScrollArea>
+#include "library/capturestore.h"
+
+// The HexView class shows a CaptureStore as offset, time, hex and ASCII columns.
+// It keeps no per-line state: the scroll bar counts rows, and paintEvent() reads and
+// formats only the rows that are on screen, so a gigabyte capture scrolls as freely
+// as a small one. Sent bytes are drawn in a different colour from received bytes.
+class HexView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit HexView(QWidget *parent = nullptr);
+
+    void setStore(const CaptureStore *captureStore); // Not owned
+
+public slots:
+    void refresh();                      // Pick up bytes appended since the last call
+    void scrollToOffset(qint64 offset);  // Bring offset to the top row and mark it
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void updateScrollRange();
+    int visibleRows() const;
+
+    const CaptureStore *store;
+    qint64 knownBytes;       // Store size as of the last refresh(); rows beyond it are not drawn
+    qint64 markedOffset;     // Byte highlighted by scrollToOffset(), or -1
+
+    static constexpr int BytesPerRow = 16;
+    static constexpr int MarginChars = 1;
+};
+
+#endif // HEXVIEW_H
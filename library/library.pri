@@ -0,0 +1,45 @@
+# Serial I/O core shared by the GUI, the command-line tool and the benchmarks.
+# Needs only QtCore and QtSerialPort.
+QT += core serialport
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/capturefile.cpp \
+    $$PWD/capturestore.cpp \
+    $$PWD/crc.cpp \
+    $$PWD/escapedtext.cpp \
+    $$PWD/firmwareuart.cpp \
+    $$PWD/framedecoder.cpp \
+    $$PWD/logwriter.cpp \
+    $$PWD/patternmatcher.cpp \
+    $$PWD/portmonitor.cpp \
+    $$PWD/replayengine.cpp \
+    $$PWD/serialmetrics.cpp \
+    $$PWD/sessionmanager.cpp \
+    $$PWD/spscringbuffer.cpp \
+    $$PWD/telemetryparser.cpp \
+    $$PWD/telemetrystore.cpp \
+    $$PWD/transmitscheduler.cpp \
+    $$PWD/triggerengine.cpp \
+    $$PWD/windowedupload.cpp
+
+HEADERS += \
+    $$PWD/capturefile.h \
+    $$PWD/capturestore.h \
+    $$PWD/crc.h \
+    $$PWD/escapedtext.h \
+    $$PWD/firmwareuart.h \
+    $$PWD/framedecoder.h \
+    $$PWD/logwriter.h \
+    $$PWD/patternmatcher.h \
+    $$PWD/portmonitor.h \
+    $$PWD/replayengine.h \
+    $$PWD/serialmetrics.h \
+    $$PWD/sessionmanager.h \
+    $$PWD/spscringbuffer.h \
+    $$PWD/telemetryparser.h \
+    $$PWD/telemetrystore.h \
+    $$PWD/transmitscheduler.h \
+    $$PWD/triggerengine.h \
+    $$PWD/windowedupload.h
@@ -0,0 +1,229 @@
+#include "library/logwriter.h"
+#include <QFileInfo>
+#include <QtEndian>
+#include <chrono>
+
+LogWriter::LogWriter(QObject *parent)
+    : QObject(parent), logFormat(Format::Text), maxBytes(0), maxAgeSecs(0), lastIndexedAt(0), stopping(false),
+      writerThread(nullptr), fileBytes(0), queuedBytes(0), writtenBytes(0), droppedBytes(0) {}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+bool LogWriter::open(const QString &filePath, Format format) {
+    close();
+
+    path = filePath;
+    logFormat = format;
+    if (!openFile()) {
+        return false;
+    }
+
+    writtenBytes = 0;
+    droppedBytes = 0;
+    stopping = false;
+    writerThread = QThread::create([this] { run(); });
+    writerThread->setObjectName("Log writer");
+    writerThread->start(QThread::LowPriority);
+    return true;
+}
+
+void LogWriter::close() {
+    if (!writerThread) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wakeWriter.wakeOne();
+    }
+    writerThread->wait();
+    delete writerThread;
+    writerThread = nullptr;
+
+    writeIndex();
+    file.close();
+}
+
+bool LogWriter::isOpen() const {
+    return writerThread != nullptr;
+}
+
+LogWriter::Format LogWriter::format() const {
+    return logFormat;
+}
+
+void LogWriter::setRotation(qint64 maxFileBytes, qint64 maxFileAgeSecs) {
+    maxBytes = qMax<qint64>(0, maxFileBytes);
+    maxAgeSecs = qMax<qint64>(0, maxFileAgeSecs);
+}
+
+quint64 LogWriter::bytesQueued() const {
+    return queuedBytes.load();
+}
+
+quint64 LogWriter::bytesWritten() const {
+    return writtenBytes.load();
+}
+
+quint64 LogWriter::bytesDropped() const {
+    return droppedBytes.load();
+}
+
+void LogWriter::append(Direction direction, const QByteArray &data) {
+    if (!writerThread || data.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (pending.size() >= MaxBacklogBytes) {
+        // The disk cannot keep up; losing log data beats stalling the port
+        droppedBytes += quint64(data.size());
+        return;
+    }
+
+    const quint64 timestampNs = quint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    const qsizetype before = pending.size();
+    if (logFormat == Format::Binary && (before == 0 || before - lastIndexedAt >= IndexIntervalBytes)) {
+        // Every batch starts with an indexed record, so each file's index starts at its first record
+        pendingIndex.append({timestampNs, quint64(before)});
+        lastIndexedAt = before;
+    }
+    appendRecord(pending, direction, data, timestampNs);
+    queuedBytes += quint64(pending.size() - before);
+    if (pending.size() >= BatchBytes) {
+        wakeWriter.wakeOne();
+    }
+}
+
+void LogWriter::appendRecord(QByteArray &batch, Direction direction, const QByteArray &data, quint64 timestampNs) {
+    if (logFormat == Format::Text) {
+        batch += (direction == Direction::Received) ? "Received data: " : "Sent data: ";
+        batch += data;
+        batch += '\n';
+        return;
+    }
+
+    char header[13];
+    qToLittleEndian<quint64>(timestampNs, header);
+    header[8] = char(direction);
+    qToLittleEndian<quint32>(quint32(data.size()), header + 9);
+    batch.append(header, sizeof(header));
+    batch += data;
+}
+
+void LogWriter::run() {
+    QByteArray batch;
+    QList<IndexEntry> batchIndex;
+    for (;;) {
+        {
+            QMutexLocker locker(&mutex);
+            if (!stopping && pending.size() < BatchBytes) {
+                wakeWriter.wait(&mutex, FlushIntervalMs);
+            }
+            // Swap rather than copy so producers get an empty buffer back immediately
+            batch.swap(pending);
+            batchIndex.swap(pendingIndex);
+            lastIndexedAt = 0;
+            if (batch.isEmpty() && stopping) {
+                return;
+            }
+        }
+
+        const qint64 ageLimit = maxAgeSecs.load();
+        const qint64 sizeLimit = maxBytes.load();
+        const bool tooOld = ageLimit > 0 && fileOpenedAt.secsTo(QDateTime::currentDateTime()) >= ageLimit;
+        const bool tooBig = sizeLimit > 0 && fileBytes > 0 && fileBytes + batch.size() > sizeLimit;
+        if ((tooOld || tooBig) && !rotate()) {
+            queuedBytes -= quint64(batch.size());
+            droppedBytes += quint64(batch.size());
+            batch.clear();
+            batchIndex.clear();
+            continue;
+        }
+
+        // Rotation has happened by now, so fileBytes is where this batch will land
+        for (const IndexEntry &entry : std::as_const(batchIndex)) {
+            fileIndex.append({entry.timestampNs, quint64(fileBytes) + entry.offset});
+        }
+        batchIndex.clear();
+
+        if (!batch.isEmpty()) {
+            const qint64 written = file.write(batch);
+            file.flush();
+            if (written != batch.size()) {
+                emit writeError(file.errorString());
+            }
+            if (written > 0) {
+                fileBytes += written;
+                writtenBytes += quint64(written);
+            }
+            queuedBytes -= quint64(batch.size());
+            batch.clear();
+        }
+    }
+}
+
+bool LogWriter::openFile() {
+    file.setFileName(path);
+    const QIODevice::OpenMode mode = (logFormat == Format::Text) ? QIODevice::WriteOnly | QIODevice::Text
+                                                                  : QIODevice::WriteOnly;
+    if (!file.open(mode)) {
+        return false;
+    }
+
+    fileBytes = 0;
+    fileOpenedAt = QDateTime::currentDateTime();
+    fileIndex.clear();
+    if (logFormat == Format::Binary) {
+        fileBytes = file.write(BinaryMagic, sizeof(BinaryMagic));
+    }
+    return true;
+}
+
+bool LogWriter::rotate() {
+    writeIndex();
+    file.close();
+
+    // Keep the live file at the configured path; finished files get a timestamp suffix
+    const QFileInfo info(path);
+    const QString stamp = fileOpenedAt.toString("yyyyMMdd-HHmmss");
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    QString rotatedPath = info.path() + "/" + info.completeBaseName() + "-" + stamp + suffix;
+    for (int n = 1; QFile::exists(rotatedPath); ++n) {
+        rotatedPath = info.path() + "/" + info.completeBaseName() + "-" + stamp + "-" + QString::number(n) + suffix;
+    }
+    QFile::rename(path, rotatedPath);
+
+    if (!openFile()) {
+        emit writeError(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Appends the seek index footer to a binary file; a no-op for text logs
+void LogWriter::writeIndex() {
+    if (logFormat != Format::Binary || !file.isOpen()) {
+        return;
+    }
+
+    QByteArray footer(fileIndex.size() * 16 + 16, Qt::Uninitialized);
+    char *out = footer.data();
+    for (const IndexEntry &entry : std::as_const(fileIndex)) {
+        qToLittleEndian<quint64>(entry.timestampNs, out);
+        qToLittleEndian<quint64>(entry.offset, out + 8);
+        out += 16;
+    }
+    qToLittleEndian<quint64>(quint64(fileBytes), out);
+    qToLittleEndian<quint64>(quint64(fileIndex.size()), out + 8);
+    footer.append(IndexMagic, sizeof(IndexMagic));
+
+    if (file.write(footer) != footer.size()) {
+        emit writeError(file.errorString());
+    }
+    fileIndex.clear();
+}
@@ -0,0 +1,108 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+
+// The LogWriter class records serial traffic to disk from a background thread.
+// append() only copies into an in-memory batch, so a slow disk never blocks the caller;
+// the writer thread flushes large batches, rotates files by size or age, and drops
+// (and counts) data once the backlog exceeds its limit.
+class LogWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Text,   // "Received data: ..." / "Sent data: ..." lines
+        Binary  // Raw capture records, see appendRecord()
+    };
+
+    enum class Direction : quint8 {
+        Received = 0,
+        Sent = 1
+    };
+
+    explicit LogWriter(QObject *parent = nullptr);
+    ~LogWriter();
+
+    bool open(const QString &filePath, Format format = Format::Text);
+    void close(); // Flushes everything queued, then stops the writer thread
+    bool isOpen() const;
+    Format format() const;
+
+    // Thread-safe; called from the serial I/O path
+    void append(Direction direction, const QByteArray &data);
+
+    // Rotation: start a new file once either limit is reached. 0 disables a limit.
+    // Thread-safe; a change while open applies from the next batch written.
+    void setRotation(qint64 maxFileBytes, qint64 maxFileAgeSecs);
+
+    // Statistics, readable from any thread
+    quint64 bytesQueued() const;   // Accepted but not yet written
+    quint64 bytesWritten() const;  // Written to disk since open()
+    quint64 bytesDropped() const;  // Discarded because the backlog was full
+
+    // Binary capture files start with this magic, followed by records of:
+    //   quint64 timestamp (ns since the Unix epoch), quint8 direction, quint32 length, payload
+    // A cleanly closed (or rotated) file ends with a seek index for CaptureFile:
+    //   entries of { quint64 timestamp, quint64 record offset }, one per batch and at least
+    //   every IndexIntervalBytes, then quint64 index offset, quint64 entry count, IndexMagic.
+    // A file without the footer (still open, or the process died) is still readable.
+    // All integers are little-endian.
+    static constexpr char BinaryMagic[8] = {'U', 'A', 'R', 'T', 'C', 'A', 'P', '1'};
+    static constexpr char IndexMagic[8] = {'U', 'A', 'R', 'T', 'I', 'D', 'X', '1'};
+    static constexpr qsizetype IndexIntervalBytes = 64 * 1024;
+
+signals:
+    void writeError(const QString &message);
+
+private:
+    void run();
+    bool openFile();
+    bool rotate();
+    void appendRecord(QByteArray &batch, Direction direction, const QByteArray &data, quint64 timestampNs);
+    void writeIndex();
+
+    struct IndexEntry {
+        quint64 timestampNs;
+        quint64 offset;
+    };
+
+    QString path;
+    Format logFormat;
+    std::atomic<qint64> maxBytes;     // Read by the writer thread
+    std::atomic<qint64> maxAgeSecs;
+
+    // Shared between producers and the writer thread, guarded by mutex
+    QMutex mutex;
+    QWaitCondition wakeWriter;
+    QByteArray pending;
+    QList<IndexEntry> pendingIndex;   // Offsets relative to the start of pending
+    qsizetype lastIndexedAt;          // Offset in pending of the newest indexed record
+    bool stopping;
+
+    // Owned by the writer thread while it runs
+    QThread *writerThread;
+    QFile file;
+    qint64 fileBytes;
+    QDateTime fileOpenedAt;
+    QList<IndexEntry> fileIndex;      // Index of the current binary file, written out when it is closed
+
+    std::atomic<quint64> queuedBytes;
+    std::atomic<quint64> writtenBytes;
+    std::atomic<quint64> droppedBytes;
+
+    static constexpr qsizetype BatchBytes = 256 * 1024;            // Wake the writer once this much is queued
+    static constexpr int FlushIntervalMs = 200;                    // Otherwise write whatever is queued this often
+    static constexpr qsizetype MaxBacklogBytes = 64 * 1024 * 1024; // Drop new data beyond this
+};
+
+#endif // LOGWRITER_H
@@ -0,0 +1,219 @@
+#include "library/patternmatcher.h"
+#include <algorithm>
+#include <iterator>
+
+static inline uchar foldCase(uchar c) {
+    return c >= 'A' && c <= 'Z' ? uchar(c + ('a' - 'A')) : c;
+}
+
+int PatternMatcher::addPattern(QByteArrayView literal, bool ignoreCase) {
+    if (literal.isEmpty() || compiled) {
+        return -1;
+    }
+    patterns.append({literal.toByteArray(), ignoreCase});
+    return int(patterns.size() - 1);
+}
+
+int PatternMatcher::patternCount() const {
+    return int(patterns.size());
+}
+
+QByteArray PatternMatcher::pattern(int id) const {
+    return id >= 0 && id < patterns.size() ? patterns[id].bytes : QByteArray();
+}
+
+bool PatternMatcher::isCompiled() const {
+    return compiled;
+}
+
+int PatternMatcher::stateCount() const {
+    return int(outputStart.size()) - 1;
+}
+
+bool PatternMatcher::compile() {
+    if (patterns.isEmpty()) {
+        return false;
+    }
+    folded = std::any_of(patterns.cbegin(), patterns.cend(), [](const Pattern &p) { return p.ignoreCase; });
+    auto key = [this](char c) { return folded ? foldCase(uchar(c)) : uchar(c); };
+
+    // Every byte that occurs in a pattern gets a class of its own and all other bytes share
+    // one, which keeps the table to a few dozen columns for text patterns
+    int classes[256];
+    std::fill(std::begin(classes), std::end(classes), -1);
+    classCount = 0;
+    maxLength = 0;
+    for (const Pattern &p : std::as_const(patterns)) {
+        for (const char c : p.bytes) {
+            if (classes[key(c)] < 0) {
+                classes[key(c)] = classCount++;
+            }
+        }
+        maxLength = qMax(maxLength, p.bytes.size());
+    }
+    const int otherClass = classCount;
+    for (int c = 0; c < 256; ++c) {
+        const int assigned = classes[key(char(c))];
+        if (assigned < 0) {
+            classCount = otherClass + 1;
+        }
+        byteClass[c] = quint8(assigned < 0 ? otherClass : assigned);
+    }
+    const int width = classCount;
+
+    // Trie of the patterns; -1 marks a missing edge
+    std::vector<int> next(size_t(width), -1);
+    std::vector<std::vector<int>> ends(1);
+    for (int id = 0; id < patterns.size(); ++id) {
+        size_t node = 0;
+        for (const char c : std::as_const(patterns[id].bytes)) {
+            const size_t edge = node * width + byteClass[uchar(c)];
+            if (next[edge] < 0) {
+                next[edge] = int(ends.size());
+                ends.emplace_back();
+                next.resize(ends.size() * width, -1);
+            }
+            node = size_t(next[edge]);
+        }
+        ends[node].push_back(id);
+    }
+    const size_t states = ends.size();
+    if (states * width >= OutputFlag) {
+        return false;
+    }
+
+    // Breadth-first, so a state's failure target is always complete before the state itself:
+    // missing edges borrow the failure target's edge, and outputs inherit its outputs
+    std::vector<int> fail(states, 0);
+    std::vector<int> order;
+    order.reserve(states);
+    for (int c = 0; c < width; ++c) {
+        if (next[c] < 0) {
+            next[c] = 0;
+        } else {
+            order.push_back(next[c]);
+        }
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        const size_t node = size_t(order[i]);
+        const size_t fallback = size_t(fail[node]) * width;
+        for (int c = 0; c < width; ++c) {
+            int &target = next[node * width + c];
+            if (target < 0) {
+                target = next[fallback + c];
+            } else {
+                fail[size_t(target)] = next[fallback + c];
+                order.push_back(target);
+            }
+        }
+        const std::vector<int> &inherited = ends[size_t(fail[node])];
+        ends[node].insert(ends[node].end(), inherited.begin(), inherited.end());
+    }
+
+    // Renumber breadth-first: the shallow states, where a scan spends nearly all its time,
+    // then share a few cache lines at the top of the table
+    std::vector<size_t> rank(states, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        rank[size_t(order[i])] = i + 1;
+    }
+    order.insert(order.begin(), 0);
+
+    outputStart.assign(states + 1, 0);
+    outputs.clear();
+    table.resize(next.size());
+    for (size_t i = 0; i < states; ++i) {
+        const size_t node = size_t(order[i]);
+        outputStart[i] = int(outputs.size());
+        outputs.insert(outputs.end(), ends[node].begin(), ends[node].end());
+
+        // Row offsets rather than state numbers save a multiply per byte
+        for (int c = 0; c < width; ++c) {
+            const size_t target = size_t(next[node * width + c]);
+            table[i * width + c] = quint32(rank[target] * width) | (ends[target].empty() ? 0 : OutputFlag);
+        }
+    }
+    outputStart[states] = int(outputs.size());
+
+    compiled = true;
+    reset();
+    return true;
+}
+
+void PatternMatcher::setMatchHandler(MatchHandler handler) {
+    this->handler = std::move(handler);
+}
+
+template <typename Report>
+quint32 PatternMatcher::run(quint32 state, QByteArrayView data, Report &&report) const {
+    const quint32 *next = table.data();
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.data());
+    const qsizetype length = data.size();
+    for (qsizetype i = 0; i < length; ++i) {
+        state = next[state + byteClass[bytes[i]]];
+        if (Q_UNLIKELY(state & OutputFlag)) {
+            state &= ~OutputFlag;
+            report(int(state / quint32(classCount)), i);
+        }
+    }
+    return state;
+}
+
+void PatternMatcher::report(int stateIndex, QByteArrayView before, QByteArrayView data, qsizetype end,
+                            qint64 base, const MatchHandler &onMatch) const {
+    for (int i = outputStart[size_t(stateIndex)]; i < outputStart[size_t(stateIndex) + 1]; ++i) {
+        const Pattern &p = patterns[outputs[size_t(i)]];
+        const qsizetype start = end + 1 - p.bytes.size();
+
+        // A folded automaton also reaches exact-case patterns on any casing; check the bytes
+        if (folded && !p.ignoreCase) {
+            const QByteArrayView expected(p.bytes);
+            const qsizetype earlier = qMax<qsizetype>(0, -start);
+            if (earlier > before.size()
+                || before.last(earlier) != expected.first(earlier)
+                || data.sliced(start + earlier, end + 1 - start - earlier) != expected.sliced(earlier)) {
+                continue;
+            }
+        }
+        onMatch(outputs[size_t(i)], base + start);
+    }
+}
+
+void PatternMatcher::feed(QByteArrayView data) {
+    if (!compiled || data.isEmpty()) {
+        return;
+    }
+    state = run(state, data, [&](int stateIndex, qsizetype end) {
+        if (handler) {
+            report(stateIndex, history, data, end, offset, handler);
+        }
+    });
+    offset += data.size();
+
+    // Enough of the stream to verify an exact-case match that started in an earlier read
+    if (folded) {
+        const qsizetype keep = maxLength - 1;
+        history.append(data.last(qMin(keep, data.size())));
+        if (history.size() > keep) {
+            history.remove(0, history.size() - keep);
+        }
+    }
+}
+
+void PatternMatcher::scan(QByteArrayView data, const MatchHandler &onMatch) const {
+    if (!compiled || !onMatch) {
+        return;
+    }
+    run(0, data, [&](int stateIndex, qsizetype end) {
+        report(stateIndex, QByteArrayView(), data, end, 0, onMatch);
+    });
+}
+
+void PatternMatcher::reset() {
+    state = 0;
+    offset = 0;
+    history.clear();
+}
+
+qint64 PatternMatcher::streamOffset() const {
+    return offset;
+}
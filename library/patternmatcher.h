@@ -0,0 +1,71 @@
+#ifndef PATTERNMATCHER_H
+#define PATTERNMATCHER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <functional>
+#include <vector>
+
+// The PatternMatcher class finds many literal byte strings in a stream in a single pass.
+// The patterns are compiled into an Aho-Corasick automaton with the failure links folded
+// into a full transition table over byte classes, so each input byte costs one table
+// lookup however many patterns there are. The automaton state is kept between feed()
+// calls, so a match split across two reads is reported when its last byte arrives.
+// Case-insensitive patterns fold ASCII letters only.
+class PatternMatcher
+{
+public:
+    // offset is the stream offset of the match's first byte
+    using MatchHandler = std::function<void(int pattern, qint64 offset)>;
+
+    PatternMatcher() = default;
+
+    // Returns the pattern id, counted from 0, or -1 for an empty pattern.
+    // Patterns cannot be added once compile() has been called.
+    int addPattern(QByteArrayView literal, bool ignoreCase = false);
+    int patternCount() const;
+    QByteArray pattern(int id) const;
+    bool compile();                   // Builds the automaton; false if there are no patterns
+    bool isCompiled() const;
+    int stateCount() const;
+
+    void setMatchHandler(MatchHandler handler);
+    void feed(QByteArrayView data);   // Reports matches through the handler as they complete
+    void reset();                     // Back to the start of a stream, e.g. after reconnecting
+    qint64 streamOffset() const;      // Bytes fed since the last reset
+
+    // Scans a self-contained buffer from the start state without touching the stream
+    // state. Only reads the compiled tables, so other threads may call it during feed().
+    void scan(QByteArrayView data, const MatchHandler &onMatch) const;
+
+private:
+    struct Pattern {
+        QByteArray bytes;
+        bool ignoreCase;
+    };
+
+    template <typename Report>
+    quint32 run(quint32 state, QByteArrayView data, Report &&report) const;
+    void report(int stateIndex, QByteArrayView before, QByteArrayView data, qsizetype end, qint64 base,
+                const MatchHandler &onMatch) const;
+
+    QList<Pattern> patterns;
+    bool folded = false;            // Case folding is on for the whole automaton; exact patterns are verified
+    bool compiled = false;
+    int classCount = 0;
+    quint8 byteClass[256] = {};
+    std::vector<quint32> table;     // Entry = target row offset, with OutputFlag if the target reports
+    std::vector<int> outputStart;   // Per state, its slice of outputs; size states + 1
+    std::vector<int> outputs;       // Pattern ids ending at each state, suffix matches included
+    qsizetype maxLength = 0;
+
+    MatchHandler handler;
+    quint32 state = 0;              // Row offset of the current state
+    qint64 offset = 0;
+    QByteArray history;             // The last maxLength - 1 bytes fed, for verifying split matches
+
+    static constexpr quint32 OutputFlag = 0x80000000u;
+};
+
+#endif // PATTERNMATCHER_H
@@ -0,0 +1,141 @@
+#include "library/portmonitor.h"
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+PortMonitor::PortMonitor(QObject *parent)
+    : QObject(parent), ueventFd(-1), notifier(nullptr), settleTimer(new QTimer(this)), pollTimer(new QTimer(this)) {
+    settleTimer->setSingleShot(true);
+    settleTimer->setInterval(SettleMs);
+    connect(settleTimer, &QTimer::timeout, this, &PortMonitor::rescan);
+
+    // The initial list is not announced; nobody is connected to the signals yet
+    knownPorts = QSerialPortInfo::availablePorts();
+
+    if (!openUeventSocket()) {
+        connect(pollTimer, &QTimer::timeout, this, &PortMonitor::rescan);
+        pollTimer->start(PollIntervalMs);
+    }
+}
+
+PortMonitor::~PortMonitor() {
+#ifdef Q_OS_LINUX
+    if (ueventFd >= 0) {
+        delete notifier;
+        ::close(ueventFd);
+    }
+#endif
+}
+
+QList<QSerialPortInfo> PortMonitor::ports() const {
+    return knownPorts;
+}
+
+bool PortMonitor::isEventDriven() const {
+    return ueventFd >= 0;
+}
+
+bool PortMonitor::openUeventSocket() {
+#ifdef Q_OS_LINUX
+    ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (ueventFd < 0) {
+        return false;
+    }
+
+    // Group 1 carries the kernel's own events; udev's rebroadcasts would need libudev
+    sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (bind(ueventFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(ueventFd);
+        ueventFd = -1;
+        return false;
+    }
+
+    notifier = new QSocketNotifier(ueventFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &PortMonitor::readUevents);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PortMonitor::readUevents() {
+#ifdef Q_OS_LINUX
+    char buffer[8192];
+    for (;;) {
+        sockaddr_nl sender;
+        socklen_t senderLength = sizeof(sender);
+        const ssize_t length = recvfrom(ueventFd, buffer, sizeof(buffer) - 1, 0,
+                                        reinterpret_cast<sockaddr *>(&sender), &senderLength);
+        if (length <= 0) {
+            break;
+        }
+        if (sender.nl_pid != 0) {
+            continue; // Only trust messages from the kernel
+        }
+        buffer[length] = '\0';
+
+        // "action@devpath" followed by NUL-separated KEY=VALUE fields
+        QByteArray action, subsystem, deviceName;
+        for (const char *field = buffer; field < buffer + length; field += strlen(field) + 1) {
+            if (strncmp(field, "ACTION=", 7) == 0) {
+                action = field + 7;
+            } else if (strncmp(field, "SUBSYSTEM=", 10) == 0) {
+                subsystem = field + 10;
+            } else if (strncmp(field, "DEVNAME=", 8) == 0) {
+                deviceName = field + 8;
+            }
+        }
+        if (subsystem != "tty" || deviceName.isEmpty()) {
+            continue;
+        }
+
+        if (action == "remove") {
+            // Report it straight away so an open session can react before its next write
+            removePort(QString::fromLocal8Bit(deviceName));
+        } else if (action == "add") {
+            settleTimer->start();
+        }
+    }
+#endif
+}
+
+void PortMonitor::removePort(const QString &portName) {
+    for (qsizetype i = 0; i < knownPorts.size(); ++i) {
+        if (knownPorts[i].portName() == portName) {
+            emit portRemoved(knownPorts.takeAt(i));
+            return;
+        }
+    }
+}
+
+void PortMonitor::rescan() {
+    const QList<QSerialPortInfo> current = QSerialPortInfo::availablePorts();
+
+    auto contains = [](const QList<QSerialPortInfo> &list, const QString &portName) {
+        for (const QSerialPortInfo &info : list) {
+            if (info.portName() == portName) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const QList<QSerialPortInfo> previous = knownPorts;
+    knownPorts = current;
+    for (const QSerialPortInfo &info : previous) {
+        if (!contains(current, info.portName())) {
+            emit portRemoved(info);
+        }
+    }
+    for (const QSerialPortInfo &info : current) {
+        if (!contains(previous, info.portName())) {
+            emit portAdded(info);
+        }
+    }
+}
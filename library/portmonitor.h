@@ -0,0 +1,50 @@
+#ifndef PORTMONITOR_H
+#define PORTMONITOR_H
+
+#include <QList>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QtSerialPort/QSerialPortInfo>
+
+// The PortMonitor class keeps an up-to-date list of serial ports without polling.
+// On Linux it listens for kernel device events on a netlink uevent socket: a tty being
+// removed is reported at once, and an add triggers one QSerialPortInfo scan after udev
+// has had a moment to finish with the device node. Elsewhere, or if the socket cannot be
+// opened, it falls back to scanning on a timer. ports() never touches the system.
+class PortMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PortMonitor(QObject *parent = nullptr);
+    ~PortMonitor();
+
+    QList<QSerialPortInfo> ports() const;   // Cached details of every known port
+    bool isEventDriven() const;             // False when falling back to polling
+
+public slots:
+    void rescan();                          // Scan now and report any differences
+
+signals:
+    void portAdded(QSerialPortInfo info);
+    void portRemoved(QSerialPortInfo info);
+
+private slots:
+    void readUevents();
+
+private:
+    bool openUeventSocket();
+    void removePort(const QString &portName);
+
+    int ueventFd;
+    QSocketNotifier *notifier;
+    QTimer *settleTimer;                    // Coalesces bursts of add events into one scan
+    QTimer *pollTimer;                      // Fallback only
+    QList<QSerialPortInfo> knownPorts;
+
+    static constexpr int SettleMs = 150;         // udev applies names and permissions after the kernel event
+    static constexpr int PollIntervalMs = 2000;
+};
+
+#endif // PORTMONITOR_H
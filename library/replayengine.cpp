@@ -0,0 +1,232 @@
+#include "library/replayengine.h"
+#include <algorithm>
+
+ReplayEngine::ReplayEngine(QObject *parent)
+    : QObject(parent), capture(nullptr), target(nullptr), records(Records::Sent), speedFactor(1.0),
+      gapLimitNs(DefaultMaxGapNs), precise(false), running(false), anchorCaptureNs(0), anchorClockNs(0),
+      skippedNs(0), position(0), positionReplayNs(0), lateNs(0), replayedBytes(0), lastProgressMs(0),
+      timer(new QTimer(this)) {
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &ReplayEngine::replayDue);
+}
+
+void ReplayEngine::setCapture(const CaptureFile *file) {
+    stop();
+    capture = file;
+}
+
+void ReplayEngine::setTarget(FirmwareUART *uart) {
+    stop();
+    if (target) {
+        disconnect(target, nullptr, this, nullptr);
+    }
+    target = uart;
+    if (target) {
+        // Unthrottled replay refills the port each time it has written everything queued
+        connect(target, &FirmwareUART::dataSent, this, [this] {
+            if (running && speedFactor <= 0.0) {
+                replayDue();
+            }
+        });
+    }
+}
+
+void ReplayEngine::setRecords(Records which) {
+    records = which;
+}
+
+void ReplayEngine::setSpeed(double factor) {
+    // Re-anchor so a change mid-replay applies from the current position onwards
+    if (running) {
+        anchorCaptureNs = positionReplayNs;
+        anchorClockNs = clock.nsecsElapsed();
+    }
+    speedFactor = qMax(0.0, factor);
+    if (running) {
+        timer->start(0);
+    }
+}
+
+double ReplayEngine::speed() const {
+    return speedFactor;
+}
+
+void ReplayEngine::setMaxGap(qint64 ns) {
+    gapLimitNs = qMax<qint64>(0, ns);
+}
+
+qint64 ReplayEngine::maxGap() const {
+    return gapLimitNs;
+}
+
+void ReplayEngine::setPrecise(bool enabled) {
+    precise = enabled;
+}
+
+bool ReplayEngine::isRunning() const {
+    return running;
+}
+
+qint64 ReplayEngine::positionNs() const {
+    return position;
+}
+
+qint64 ReplayEngine::maxLatenessNs() const {
+    return lateNs;
+}
+
+quint64 ReplayEngine::bytesReplayed() const {
+    return replayedBytes;
+}
+
+bool ReplayEngine::start(qint64 fromTimestampNs) {
+    stop();
+    if (!capture || !capture->isOpen() || (target && !target->isConnected())) {
+        return false;
+    }
+
+    nextRecord = (fromTimestampNs > 0) ? capture->seek(fromTimestampNs) : capture->first();
+    if (!nextRecord.isValid()) {
+        emit finished();
+        return true;
+    }
+
+    clock.start();
+    anchorCaptureNs = nextRecord.timestampNs;
+    anchorClockNs = 0;
+    skippedNs = 0;
+    position = nextRecord.timestampNs;
+    positionReplayNs = position;
+    lateNs = 0;
+    replayedBytes = 0;
+    lastProgressMs = 0;
+    running = true;
+    replayDue();
+    return true;
+}
+
+void ReplayEngine::stop() {
+    running = false;
+    timer->stop();
+    nextRecord = CaptureFile::Record();
+}
+
+bool ReplayEngine::wanted(const CaptureFile::Record &record) const {
+    switch (records) {
+    case Records::Sent:
+        return record.direction == LogWriter::Direction::Sent;
+    case Records::Received:
+        return record.direction == LogWriter::Direction::Received;
+    case Records::All:
+        break;
+    }
+    return true;
+}
+
+qint64 ReplayEngine::dueNs(const CaptureFile::Record &record) const {
+    return anchorClockNs + qint64(double(record.timestampNs - skippedNs - anchorCaptureNs) / speedFactor);
+}
+
+// The part of a gap that is dropped is added to skippedNs, which moves every later record with it
+void ReplayEngine::advance() {
+    position = nextRecord.timestampNs;
+    positionReplayNs = position - skippedNs;
+    nextRecord = capture->next(nextRecord);
+    if (!nextRecord.isValid()) {
+        return;
+    }
+    const qint64 gap = nextRecord.timestampNs - position;
+    if (gap < 0) {
+        skippedNs += gap;
+    } else if (gapLimitNs > 0 && gap > gapLimitNs) {
+        skippedNs += gap - gapLimitNs;
+    }
+}
+
+void ReplayEngine::replayDue() {
+    if (!running) {
+        return;
+    }
+    const bool unthrottled = speedFactor <= 0.0;
+    if (unthrottled && target && target->transmitPending() > 0) {
+        return; // dataSent() calls back once the port has caught up
+    }
+
+    const qint64 spinNs = precise ? SpinNs : 0;
+    QByteArray batch;
+    while (nextRecord.isValid() && batch.size() < BatchBytes) {
+        if (!unthrottled) {
+            const qint64 due = dueNs(nextRecord);
+            qint64 waitNs = due - clock.nsecsElapsed();
+            if (waitNs > spinNs) {
+                break;
+            }
+            if (waitNs > 0) {
+                // Whatever is already due goes out now rather than after the spin
+                if (!flush(batch)) {
+                    return;
+                }
+                while (waitNs > 0) {
+                    waitNs = due - clock.nsecsElapsed();
+                }
+            }
+            lateNs = std::max(lateNs, -waitNs);
+        }
+
+        if (wanted(nextRecord)) {
+            const QByteArray payload = nextRecord.payload.toByteArray();
+            batch += payload;
+            replayedBytes += quint64(payload.size());
+            emit recordReplayed(nextRecord.direction, payload);
+        }
+        advance();
+    }
+    if (!flush(batch)) {
+        return;
+    }
+
+    if (!nextRecord.isValid()) {
+        running = false;
+        reportProgress(true);
+        emit finished();
+        return;
+    }
+    reportProgress(false);
+
+    if (unthrottled) {
+        // With a target, dataSent() drives the next step; otherwise yield to the event loop
+        if (!target || target->transmitPending() == 0) {
+            timer->start(0);
+        }
+    } else {
+        // Timers may wake a little early: a precise replay busy-waits the rest above, otherwise
+        // the timer is rounded up so it does not fire before the record is due
+        const qint64 waitNs = dueNs(nextRecord) - clock.nsecsElapsed() - spinNs;
+        timer->start(int(qMax<qint64>(0, precise ? waitNs / 1000000 : (waitNs + 999999) / 1000000)));
+    }
+}
+
+// Hands the batch to the port; stops the replay if the port refuses it
+bool ReplayEngine::flush(QByteArray &batch) {
+    if (batch.isEmpty() || !target) {
+        batch.clear();
+        return true;
+    }
+    const bool ok = target->writeData(batch);
+    batch.clear();
+    if (!ok) {
+        stop();
+        emit finished();
+    }
+    return ok;
+}
+
+void ReplayEngine::reportProgress(bool force) {
+    const qint64 elapsedMs = clock.elapsed();
+    if (!force && elapsedMs - lastProgressMs < ProgressIntervalMs) {
+        return;
+    }
+    lastProgressMs = elapsedMs;
+    emit progress(position, capture->endTimeNs());
+}
@@ -0,0 +1,93 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include "library/capturefile.h"
+#include "library/firmwareuart.h"
+
+// The ReplayEngine class plays a CaptureFile back out through a FirmwareUART's transmit
+// path, with the original spacing between records, scaled by a speed factor, or as fast
+// as the port accepts. Every record is scheduled against one monotonic clock anchored at
+// start(), so timer jitter never accumulates: a late record delays only itself.
+// Capture timestamps come from the wall clock, so a gap that runs backwards is replayed
+// as no gap and one longer than maxGap() is shortened to it; a clock step while capturing
+// then costs at most maxGap(). Records are sent when the timer fires, to its millisecond
+// resolution; setPrecise() busy-waits the last SpinNs instead, at the cost of holding the
+// session's thread. Records due together are coalesced into one write. Without a target
+// the engine only emits recordReplayed(), which is enough to drive a FrameDecoder offline.
+// The engine must live on the target's thread.
+class ReplayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Records {
+        Sent,      // What the host sent: replay against the device
+        Received,  // What the device sent: stand in for the device
+        All
+    };
+
+    explicit ReplayEngine(QObject *parent = nullptr);
+
+    void setCapture(const CaptureFile *file);     // Not owned; must stay open while running
+    void setTarget(FirmwareUART *uart);           // Not owned; null replays into signals only
+    void setRecords(Records which);
+    void setSpeed(double factor);                 // 1 = original timing, 2 = twice as fast, 0 = unthrottled
+    double speed() const;
+    void setMaxGap(qint64 ns);                    // Longest pause replayed, in capture time; 0 for no limit
+    qint64 maxGap() const;
+    void setPrecise(bool enabled);                // Busy-wait the last SpinNs before each record
+
+    bool isRunning() const;
+    qint64 positionNs() const;                    // Capture timestamp of the last record replayed
+    qint64 maxLatenessNs() const;                 // Worst delay of a record behind its schedule
+    quint64 bytesReplayed() const;
+
+public slots:
+    bool start(qint64 fromTimestampNs = 0);       // 0 starts at the first record
+    void stop();
+
+signals:
+    void recordReplayed(LogWriter::Direction direction, QByteArray payload);
+    void progress(qint64 positionNs, qint64 endNs);
+    void finished();
+
+private slots:
+    void replayDue();
+
+private:
+    bool wanted(const CaptureFile::Record &record) const;
+    qint64 dueNs(const CaptureFile::Record &record) const;  // On clock's time base
+    void advance();                               // Moves to the next record, clamping the gap before it
+    bool flush(QByteArray &batch);
+    void reportProgress(bool force);
+
+    const CaptureFile *capture;
+    FirmwareUART *target;
+    Records records;
+    double speedFactor;
+    qint64 gapLimitNs;
+    bool precise;
+    bool running;
+
+    CaptureFile::Record nextRecord;
+    QElapsedTimer clock;
+    qint64 anchorCaptureNs;   // Capture time, less skippedNs, that maps to anchorClockNs
+    qint64 anchorClockNs;
+    qint64 skippedNs;         // Capture time dropped by clamping gaps so far
+    qint64 position;
+    qint64 positionReplayNs;  // position less the skippedNs that applied to it
+    qint64 lateNs;
+    quint64 replayedBytes;
+    qint64 lastProgressMs;
+    QTimer *timer;
+
+    static constexpr qsizetype BatchBytes = 64 * 1024; // Most bytes handed to the port per step
+    static constexpr qint64 SpinNs = 200000;           // With setPrecise(), busy-wait the last 0.2 ms
+    static constexpr qint64 DefaultMaxGapNs = 60LL * 1000000000;
+    static constexpr qint64 ProgressIntervalMs = 100;
+};
+
+#endif // REPLAYENGINE_H
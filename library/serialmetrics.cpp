@@ -0,0 +1,124 @@
+#include "library/serialmetrics.h"
+#include <cmath>
+
+SerialMetrics::SerialMetrics() {
+    reset();
+}
+
+void SerialMetrics::reset() {
+    QMutexLocker locker(&mutex);
+    for (Counters &c : counters) {
+        c.bytes.store(0, std::memory_order_relaxed);
+        c.chunks.store(0, std::memory_order_relaxed);
+        c.lastChunkNs.store(-1, std::memory_order_relaxed);
+        for (auto &bucket : c.chunkSizeBytes) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        for (auto &bucket : c.gapNs) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    errorCount.store(0, std::memory_order_relaxed);
+    overrunCount.store(0, std::memory_order_relaxed);
+    droppedCount.store(0, std::memory_order_relaxed);
+
+    window.clear();
+    windowBps[Receive] = windowBps[Transmit] = 0.0;
+    ewmaBps[Receive] = ewmaBps[Transmit] = 0.0;
+    clock.start();
+}
+
+int SerialMetrics::bucketFor(quint64 value) {
+    int bucket = 0;
+    while (value != 0 && bucket < HistogramBuckets - 1) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void SerialMetrics::recordChunk(Direction direction, qint64 bytes) {
+    if (bytes <= 0) {
+        return;
+    }
+
+    // Only the I/O thread records, so relaxed ordering is enough; readers accept a torn view
+    Counters &c = counters[direction];
+    const qint64 nowNs = clock.nsecsElapsed();
+    c.bytes.fetch_add(quint64(bytes), std::memory_order_relaxed);
+    c.chunks.fetch_add(1, std::memory_order_relaxed);
+    c.chunkSizeBytes[bucketFor(quint64(bytes))].fetch_add(1, std::memory_order_relaxed);
+
+    const qint64 lastNs = c.lastChunkNs.exchange(nowNs, std::memory_order_relaxed);
+    if (lastNs >= 0) {
+        c.gapNs[bucketFor(quint64(nowNs - lastNs))].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SerialMetrics::recordError() {
+    errorCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SerialMetrics::recordOverrun(quint64 droppedBytes) {
+    overrunCount.fetch_add(1, std::memory_order_relaxed);
+    droppedCount.fetch_add(droppedBytes, std::memory_order_relaxed);
+}
+
+void SerialMetrics::sample() {
+    QMutexLocker locker(&mutex);
+    const Sample now = {clock.nsecsElapsed(),
+                        {counters[Receive].bytes.load(std::memory_order_relaxed),
+                         counters[Transmit].bytes.load(std::memory_order_relaxed)}};
+
+    if (!window.empty()) {
+        // EWMA over the per-sample rate, weighted by how long the sample interval was
+        const Sample &previous = window.back();
+        const qint64 dtNs = now.timeNs - previous.timeNs;
+        if (dtNs > 0) {
+            const double alpha = 1.0 - std::exp(-double(dtNs) / EwmaTimeConstantNs);
+            for (int d = 0; d < 2; ++d) {
+                const double instantBps = (now.bytes[d] - previous.bytes[d]) * 8 * 1e9 / dtNs;
+                ewmaBps[d] += alpha * (instantBps - ewmaBps[d]);
+            }
+        }
+    }
+
+    window.push_back(now);
+    while (window.size() > 2 && now.timeNs - window[1].timeNs >= WindowNs) {
+        window.pop_front();
+    }
+
+    const Sample &oldest = window.front();
+    const qint64 spanNs = now.timeNs - oldest.timeNs;
+    for (int d = 0; d < 2; ++d) {
+        windowBps[d] = (spanNs > 0) ? (now.bytes[d] - oldest.bytes[d]) * 8 * 1e9 / spanNs : 0.0;
+    }
+}
+
+void SerialMetrics::copyHistogram(const std::array<std::atomic<quint64>, HistogramBuckets> &from, Histogram &to) {
+    for (int i = 0; i < HistogramBuckets; ++i) {
+        to[i] = from[i].load(std::memory_order_relaxed);
+    }
+}
+
+SerialMetrics::Snapshot SerialMetrics::snapshot() const {
+    Snapshot result;
+    QMutexLocker locker(&mutex);
+    result.elapsedNs = clock.nsecsElapsed();
+
+    DirectionStats *stats[2] = {&result.receive, &result.transmit};
+    for (int d = 0; d < 2; ++d) {
+        const Counters &c = counters[d];
+        stats[d]->totalBytes = c.bytes.load(std::memory_order_relaxed);
+        stats[d]->chunks = c.chunks.load(std::memory_order_relaxed);
+        stats[d]->windowBps = windowBps[d];
+        stats[d]->ewmaBps = ewmaBps[d];
+        copyHistogram(c.chunkSizeBytes, stats[d]->chunkSizeBytes);
+        copyHistogram(c.gapNs, stats[d]->gapNs);
+    }
+
+    result.errors = errorCount.load(std::memory_order_relaxed);
+    result.overruns = overrunCount.load(std::memory_order_relaxed);
+    result.droppedBytes = droppedCount.load(std::memory_order_relaxed);
+    return result;
+}
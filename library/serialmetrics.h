@@ -0,0 +1,89 @@
+#ifndef SERIALMETRICS_H
+#define SERIALMETRICS_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <deque>
+
+// The SerialMetrics class collects throughput and timing statistics for one serial session.
+// The record*() calls on the I/O path only bump relaxed atomic counters; rates are derived
+// by sample() on a timer, and everything is read back through a single snapshot().
+class SerialMetrics
+{
+public:
+    enum Direction {
+        Receive = 0,
+        Transmit = 1
+    };
+
+    // Bucket 0 counts zero; bucket i counts values in [2^(i-1), 2^i); the last bucket is open-ended
+    static constexpr int HistogramBuckets = 40;
+    using Histogram = std::array<quint64, HistogramBuckets>;
+
+    struct DirectionStats {
+        quint64 totalBytes = 0;
+        quint64 chunks = 0;
+        double windowBps = 0.0;       // Bits per second over the sliding window
+        double ewmaBps = 0.0;         // Exponentially weighted moving average, bits per second
+        Histogram chunkSizeBytes {};  // Bytes per read or per bytesWritten notification
+        Histogram gapNs {};           // Time between consecutive chunks
+    };
+
+    struct Snapshot {
+        qint64 elapsedNs = 0;         // Since the last reset()
+        DirectionStats receive;
+        DirectionStats transmit;
+        quint64 errors = 0;
+        quint64 overruns = 0;
+        quint64 droppedBytes = 0;     // Received bytes lost to receive buffer overruns
+        quint64 logDroppedBytes = 0;  // Filled in by the owner of the log writer
+    };
+
+    SerialMetrics();
+
+    void reset(); // Start a new session: clears counters and restarts the clock
+
+    // Hot path, called from the I/O thread
+    void recordChunk(Direction direction, qint64 bytes);
+    void recordError();
+    void recordOverrun(quint64 droppedBytes);
+
+    void sample();               // Updates the derived rates; call on a fixed timer
+    Snapshot snapshot() const;   // Thread-safe
+
+    static constexpr qint64 WindowNs = 1000000000;   // Sliding window length
+    static constexpr qint64 EwmaTimeConstantNs = 2000000000;
+
+private:
+    struct Counters {
+        std::atomic<quint64> bytes {0};
+        std::atomic<quint64> chunks {0};
+        std::atomic<qint64> lastChunkNs {-1};
+        std::array<std::atomic<quint64>, HistogramBuckets> chunkSizeBytes {};
+        std::array<std::atomic<quint64>, HistogramBuckets> gapNs {};
+    };
+
+    struct Sample {
+        qint64 timeNs;
+        quint64 bytes[2];
+    };
+
+    static int bucketFor(quint64 value);
+    static void copyHistogram(const std::array<std::atomic<quint64>, HistogramBuckets> &from, Histogram &to);
+
+    QElapsedTimer clock;
+    Counters counters[2];
+    std::atomic<quint64> errorCount {0};
+    std::atomic<quint64> overrunCount {0};
+    std::atomic<quint64> droppedCount {0};
+
+    // Derived by sample(), guarded by mutex
+    mutable QMutex mutex;
+    std::deque<Sample> window;
+    double windowBps[2];
+    double ewmaBps[2];
+};
+
+#endif // SERIALMETRICS_H
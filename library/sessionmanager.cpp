@@ -0,0 +1,200 @@
+#include "library/sessionmanager.h"
+#include <algorithm>
+
+static void addDirection(SerialMetrics::DirectionStats &total, const SerialMetrics::DirectionStats &stats) {
+    total.totalBytes += stats.totalBytes;
+    total.chunks += stats.chunks;
+    total.windowBps += stats.windowBps;
+    total.ewmaBps += stats.ewmaBps;
+    for (int i = 0; i < SerialMetrics::HistogramBuckets; ++i) {
+        total.chunkSizeBytes[i] += stats.chunkSizeBytes[i];
+        total.gapNs[i] += stats.gapNs[i];
+    }
+}
+
+SessionManager::SessionManager(int ioThreads, QObject *parent) : QObject(parent), portMonitor(nullptr), nextId(1) {
+    if (ioThreads <= 0) {
+        ioThreads = qBound(1, QThread::idealThreadCount() / 2, MaxDefaultThreads);
+    }
+    for (int i = 0; i < ioThreads; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("Serial I/O %1").arg(i));
+        thread->start();
+        threads << thread;
+        sessionsPerThread << 0;
+    }
+}
+
+SessionManager::~SessionManager() {
+    shutdown();
+}
+
+int SessionManager::addSession(FirmwareUART *uart) {
+    const int thread = int(std::min_element(sessionsPerThread.begin(), sessionsPerThread.end())
+                           - sessionsPerThread.begin());
+    uart->setParent(nullptr);
+    uart->moveToThread(threads[thread]);
+    ++sessionsPerThread[thread];
+
+    const int id = nextId++;
+    sessionMap.insert(id, {uart, thread, QString(), 0});
+    watchPortRemoval(uart);
+    connect(uart, &FirmwareUART::logWriteError, this, [this, id](const QString &message) {
+        emit logWriteError(id, message);
+    });
+    return id;
+}
+
+void SessionManager::setPortMonitor(PortMonitor *monitor) {
+    for (const Session &session : std::as_const(sessionMap)) {
+        if (portMonitor) {
+            disconnect(portMonitor, nullptr, session.uart, nullptr);
+        }
+    }
+    portMonitor = monitor;
+    for (const Session &session : std::as_const(sessionMap)) {
+        watchPortRemoval(session.uart);
+    }
+}
+
+// The lambda runs on the session's own thread, since uart is the context object
+void SessionManager::watchPortRemoval(FirmwareUART *uart) {
+    if (!portMonitor) {
+        return;
+    }
+    connect(portMonitor, &PortMonitor::portRemoved, uart, [uart](const QSerialPortInfo &info) {
+        uart->handlePortRemoved(info.portName());
+    });
+}
+
+void SessionManager::removeSession(int id) {
+    if (!sessionMap.contains(id)) {
+        return;
+    }
+    const Session session = sessionMap.take(id);
+    --sessionsPerThread[session.thread];
+
+    FirmwareUART *uart = session.uart;
+    QMetaObject::invokeMethod(uart, [uart] {
+        uart->disconnectFromPort();
+        uart->closeLogFile();
+    }, Qt::BlockingQueuedConnection);
+    uart->deleteLater(); // Deleted on its own thread, after any events already queued for it
+}
+
+void SessionManager::shutdown() {
+    if (threads.isEmpty()) {
+        return;
+    }
+
+    // Close every port on its own thread, then stop the threads and delete what is left
+    for (const Session &session : std::as_const(sessionMap)) {
+        FirmwareUART *uart = session.uart;
+        QMetaObject::invokeMethod(uart, [uart] {
+            uart->disconnectFromPort();
+            uart->closeLogFile();
+        }, Qt::BlockingQueuedConnection);
+    }
+    for (QThread *thread : std::as_const(threads)) {
+        thread->quit();
+        thread->wait();
+    }
+    for (const Session &session : std::as_const(sessionMap)) {
+        delete session.uart;
+    }
+    sessionMap.clear();
+    qDeleteAll(threads);
+    threads.clear();
+    sessionsPerThread.clear();
+}
+
+int SessionManager::openSession(const QString &portName, int baudRate, const QString &logPath,
+                                LogWriter::Format logFormat, qint64 logMaxFileBytes, qint64 logMaxFileAgeSecs) {
+    const int id = addSession(new FirmwareUART);
+    const bool logged = logPath.isEmpty()
+                        || setupSessionLog(id, logPath, logFormat, logMaxFileBytes, logMaxFileAgeSecs);
+    if (!logged || !connectSession(id, portName, baudRate)) {
+        removeSession(id);
+        return -1;
+    }
+    return id;
+}
+
+bool SessionManager::connectSession(int id, const QString &portName, int baudRate) {
+    auto it = sessionMap.find(id);
+    if (it == sessionMap.end()) {
+        return false;
+    }
+    it->portName = portName;
+    it->baudRate = baudRate;
+
+    FirmwareUART *uart = it->uart;
+    bool opened = false;
+    QMetaObject::invokeMethod(uart, [uart, portName, baudRate] {
+        return uart->connectToPort(portName, baudRate);
+    }, Qt::BlockingQueuedConnection, &opened);
+    return opened;
+}
+
+void SessionManager::disconnectSession(int id) {
+    if (FirmwareUART *uart = session(id)) {
+        QMetaObject::invokeMethod(uart, &FirmwareUART::disconnectFromPort, Qt::BlockingQueuedConnection);
+    }
+}
+
+bool SessionManager::setupSessionLog(int id, const QString &filePath, LogWriter::Format format,
+                                     qint64 maxFileBytes, qint64 maxFileAgeSecs) {
+    FirmwareUART *uart = session(id);
+    if (!uart) {
+        return false;
+    }
+    bool opened = false;
+    QMetaObject::invokeMethod(uart, [uart, filePath, format, maxFileBytes, maxFileAgeSecs] {
+        uart->setLogRotation(maxFileBytes, maxFileAgeSecs);
+        return uart->setupLogFile(filePath, format);
+    }, Qt::BlockingQueuedConnection, &opened);
+    return opened;
+}
+
+FirmwareUART *SessionManager::session(int id) const {
+    const auto it = sessionMap.constFind(id);
+    return (it != sessionMap.constEnd()) ? it->uart : nullptr;
+}
+
+QList<int> SessionManager::sessionIds() const {
+    QList<int> ids = sessionMap.keys();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QString SessionManager::portName(int id) const {
+    return sessionMap.value(id).portName;
+}
+
+int SessionManager::baudRate(int id) const {
+    return sessionMap.value(id).baudRate;
+}
+
+int SessionManager::ioThreadCount() const {
+    return int(threads.size());
+}
+
+SerialMetrics::Snapshot SessionManager::sessionStats(int id) const {
+    const FirmwareUART *uart = session(id);
+    return uart ? uart->metricsSnapshot() : SerialMetrics::Snapshot();
+}
+
+SerialMetrics::Snapshot SessionManager::aggregateStats() const {
+    SerialMetrics::Snapshot total;
+    for (const Session &session : sessionMap) {
+        const SerialMetrics::Snapshot stats = session.uart->metricsSnapshot();
+        total.elapsedNs = qMax(total.elapsedNs, stats.elapsedNs);
+        addDirection(total.receive, stats.receive);
+        addDirection(total.transmit, stats.transmit);
+        total.errors += stats.errors;
+        total.overruns += stats.overruns;
+        total.droppedBytes += stats.droppedBytes;
+        total.logDroppedBytes += stats.logDroppedBytes;
+    }
+    return total;
+}
@@ -0,0 +1,77 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include "library/firmwareuart.h"
+#include "library/portmonitor.h"
+
+// The SessionManager class runs many FirmwareUART sessions on a small, fixed pool of
+// I/O threads. Each thread's event loop multiplexes every port assigned to it (poll/epoll
+// underneath), so 32 ports cost a handful of threads rather than 32 event loops.
+// Sessions keep their own settings, log and metrics; totals are summed on request.
+// All methods are called from the thread that owns the manager.
+class SessionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionManager(int ioThreads = 0, QObject *parent = nullptr); // 0 picks a default from the CPU count
+    ~SessionManager();
+
+    // Takes ownership and moves the session to the least busy I/O thread.
+    // Configure ring buffers, decoders and capture stores before adding.
+    int addSession(FirmwareUART *uart);
+    void removeSession(int id);   // Disconnects, closes the log and deletes the session
+    void shutdown();              // Removes every session and stops the I/O threads
+
+    // Convenience for a plain monitoring session: create, log and connect in one call.
+    // Returns the session id, or -1 if the log or the port could not be opened.
+    int openSession(const QString &portName, int baudRate, const QString &logPath = QString(),
+                    LogWriter::Format logFormat = LogWriter::Format::Text, qint64 logMaxFileBytes = 0,
+                    qint64 logMaxFileAgeSecs = 0);
+
+    // Run on the session's own thread; block until done
+    bool connectSession(int id, const QString &portName, int baudRate);
+    void disconnectSession(int id);
+    bool setupSessionLog(int id, const QString &filePath, LogWriter::Format format, qint64 maxFileBytes = 0,
+                         qint64 maxFileAgeSecs = 0); // Rotation limits as in LogWriter; 0 disables one
+
+    // Sessions whose port is unplugged disconnect as soon as the monitor reports it.
+    // Applies to existing and future sessions; the monitor is not owned.
+    void setPortMonitor(PortMonitor *monitor);
+
+    FirmwareUART *session(int id) const;
+    QList<int> sessionIds() const;
+    QString portName(int id) const;   // Port given to connectSession(), empty if never connected
+    int baudRate(int id) const;
+    int ioThreadCount() const;
+
+    SerialMetrics::Snapshot sessionStats(int id) const;
+    SerialMetrics::Snapshot aggregateStats() const; // Counters, rates and histograms summed over sessions
+
+    static constexpr int MaxDefaultThreads = 4;
+
+signals:
+    void logWriteError(int id, QString message);  // A session's log writer failed; delivered on this thread
+
+private:
+    void watchPortRemoval(FirmwareUART *uart);
+
+    struct Session {
+        FirmwareUART *uart;
+        int thread;
+        QString portName;
+        int baudRate;
+    };
+
+    QList<QThread *> threads;
+    QList<int> sessionsPerThread;
+    QHash<int, Session> sessionMap;
+    PortMonitor *portMonitor;
+    int nextId;
+};
+
+#endif // SESSIONMANAGER_H
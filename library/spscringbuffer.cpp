@@ -0,0 +1,63 @@
+#include "library/spscringbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+static quint64 roundUpToPowerOfTwo(quint64 value) {
+    quint64 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+SpscRingBuffer::SpscRingBuffer(qsizetype capacity)
+    : buffer(roundUpToPowerOfTwo(quint64(qMax<qsizetype>(capacity, 2)))),
+      mask(buffer.size() - 1), head(0), tail(0) {}
+
+qsizetype SpscRingBuffer::capacity() const {
+    return qsizetype(buffer.size());
+}
+
+qsizetype SpscRingBuffer::size() const {
+    return qsizetype(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+qsizetype SpscRingBuffer::write(const char *data, qsizetype length) {
+    const quint64 currentHead = head.load(std::memory_order_relaxed);
+    const quint64 currentTail = tail.load(std::memory_order_acquire);
+    const quint64 freeBytes = buffer.size() - (currentHead - currentTail);
+    const quint64 count = std::min<quint64>(freeBytes, quint64(length));
+    if (count == 0) {
+        return 0;
+    }
+
+    // Copy in at most two pieces: up to the end of the storage, then from the start
+    const quint64 start = currentHead & mask;
+    const quint64 first = std::min<quint64>(count, buffer.size() - start);
+    std::memcpy(buffer.data() + start, data, first);
+    std::memcpy(buffer.data(), data + first, count - first);
+
+    head.store(currentHead + count, std::memory_order_release);
+    return qsizetype(count);
+}
+
+qsizetype SpscRingBuffer::read(char *data, qsizetype maxLength) {
+    const quint64 currentTail = tail.load(std::memory_order_relaxed);
+    const quint64 currentHead = head.load(std::memory_order_acquire);
+    const quint64 count = std::min<quint64>(currentHead - currentTail, quint64(maxLength));
+    if (count == 0) {
+        return 0;
+    }
+
+    const quint64 start = currentTail & mask;
+    const quint64 first = std::min<quint64>(count, buffer.size() - start);
+    std::memcpy(data, buffer.data() + start, first);
+    std::memcpy(data + first, buffer.data(), count - first);
+
+    tail.store(currentTail + count, std::memory_order_release);
+    return qsizetype(count);
+}
+
+void SpscRingBuffer::clear() {
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
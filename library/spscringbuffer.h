@@ -0,0 +1,36 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+// Fixed-capacity byte ring shared by exactly one producer thread and one consumer thread.
+// Neither side takes a lock: each index is written by one side only and published with
+// release/acquire ordering. When the ring is full, write() accepts what fits and the
+// caller decides what to do with the rest.
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(qsizetype capacity); // Rounded up to a power of two
+
+    qsizetype capacity() const;
+    qsizetype size() const; // Bytes currently buffered (a snapshot when called cross-thread)
+
+    // Producer side
+    qsizetype write(const char *data, qsizetype length); // Returns bytes accepted
+
+    // Consumer side
+    qsizetype read(char *data, qsizetype maxLength);     // Returns bytes copied out
+    void clear();
+
+private:
+    std::vector<char> buffer;
+    quint64 mask;
+
+    // Kept on separate cache lines so producer and consumer do not false-share
+    alignas(64) std::atomic<quint64> head; // Next byte to write, owned by the producer
+    alignas(64) std::atomic<quint64> tail; // Next byte to read, owned by the consumer
+};
+
+#endif // SPSCRINGBUFFER_H
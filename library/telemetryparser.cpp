@@ -0,0 +1,267 @@
+#include "library/telemetryparser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';';
+}
+
+QByteArrayView trimmed(QByteArrayView text) {
+    while (!text.isEmpty() && (text.front() == ' ' || text.front() == '\t')) {
+        text = text.sliced(1);
+    }
+    while (!text.isEmpty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.chop(1);
+    }
+    return text;
+}
+
+// 21.5, -3e-2, +7, or with a unit suffix: 3.3V, 45%, 12.0degC
+bool parseNumber(QByteArrayView text, double *value) {
+    const char *begin = text.data();
+    const char *end = begin + text.size();
+    if (begin != end && *begin == '+') {
+        ++begin;
+    }
+    // from_chars would also take inf and nan, which are words here
+    const char *digit = (begin != end && *begin == '-') ? begin + 1 : begin;
+    if (digit == end || !((*digit >= '0' && *digit <= '9') || *digit == '.')) {
+        return false;
+    }
+    const auto result = std::from_chars(begin, end, *value);
+    if (result.ec != std::errc() || result.ptr == begin) {
+        return false;
+    }
+    for (const char *unit = result.ptr; unit != end; ++unit) {
+        if (!((*unit >= 'a' && *unit <= 'z') || (*unit >= 'A' && *unit <= 'Z') || *unit == '%' || *unit == '/')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isIdentifier(QByteArrayView text) {
+    if (text.isEmpty() || (text.front() >= '0' && text.front() <= '9')) {
+        return false;
+    }
+    for (char c : text) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TelemetryParser::TelemetryParser(TelemetryStore *store)
+    : target(store), overlong(false), timestamp(0), nextKnown(0), batched(0), lineSamples(0) {
+    partial.reserve(MaxLineBytes);
+}
+
+TelemetryStore *TelemetryParser::store() const {
+    return target;
+}
+
+quint64 TelemetryParser::sampleCount() const {
+    return samples.load(std::memory_order_relaxed);
+}
+
+quint64 TelemetryParser::lineCount() const {
+    return lines.load(std::memory_order_relaxed);
+}
+
+void TelemetryParser::reset() {
+    partial.clear();
+    overlong = false;
+    header.clear();
+}
+
+void TelemetryParser::setChannelFilter(const QList<QByteArray> &names) {
+    filter.assign(names.begin(), names.end());
+    // Cached names and columns were resolved under the old filter
+    known.clear();
+    nextKnown = 0;
+    header.clear();
+    plainColumns.clear();
+}
+
+bool TelemetryParser::allowed(QByteArrayView name) const {
+    return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+}
+
+void TelemetryParser::feed(QByteArrayView data, qint64 timestampNs) {
+    if (!target || data.isEmpty()) {
+        return;
+    }
+    timestamp = timestampNs;
+
+    // Whole lines are parsed in place; only the unfinished end of a read is copied
+    qsizetype start = 0;
+    while (start < data.size()) {
+        const char *newline = static_cast<const char *>(
+            std::memchr(data.data() + start, '\n', size_t(data.size() - start)));
+        const qsizetype end = newline ? newline - data.data() : data.size();
+        const QByteArrayView piece = data.sliced(start, end - start);
+
+        if (!overlong && partial.size() + piece.size() > MaxLineBytes) {
+            overlong = true;
+            partial.clear();
+        }
+        if (newline) {
+            if (!overlong) {
+                if (partial.isEmpty()) {
+                    parseLine(piece);
+                } else {
+                    partial.append(piece);
+                    parseLine(partial);
+                    partial.clear();
+                }
+            }
+            overlong = false;
+        } else if (!overlong) {
+            partial.append(piece);
+        }
+        start = end + 1;
+    }
+    flush();
+}
+
+void TelemetryParser::parseLine(QByteArrayView line) {
+    if (line.endsWith('\r')) {
+        line.chop(1);
+    }
+    if (line.isEmpty()) {
+        return;
+    }
+    lineSamples = 0;
+    if (std::memchr(line.data(), '=', size_t(line.size()))) {
+        parseKeyValues(line);
+    } else {
+        parseCsv(line);
+    }
+    if (lineSamples > 0) {
+        lines.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TelemetryParser::parseKeyValues(QByteArrayView line) {
+    qsizetype pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && isSeparator(line[pos])) {
+            ++pos;
+        }
+        const qsizetype start = pos;
+        while (pos < line.size() && !isSeparator(line[pos])) {
+            ++pos;
+        }
+        const QByteArrayView token = line.sliced(start, pos - start);
+        const qsizetype equals = token.indexOf('=');
+        double value;
+        if (equals > 0 && parseNumber(token.sliced(equals + 1), &value)) {
+            add(channelFor(token.first(equals)), value);
+        }
+    }
+}
+
+void TelemetryParser::parseCsv(QByteArrayView line) {
+    char delimiter = 0;
+    for (char candidate : {',', ';', '\t'}) {
+        if (std::memchr(line.data(), candidate, size_t(line.size()))) {
+            delimiter = candidate;
+            break;
+        }
+    }
+
+    std::array<double, TelemetryStore::MaxChannels> values;
+    std::array<QByteArrayView, TelemetryStore::MaxChannels> fields;
+    int count = 0;
+    int numbers = 0;
+    bool names = true;
+    qsizetype pos = 0;
+    for (;;) {
+        qsizetype end = delimiter ? line.indexOf(delimiter, pos) : -1;
+        if (end < 0) {
+            end = line.size();
+        }
+        if (count == TelemetryStore::MaxChannels) {
+            return;
+        }
+        const QByteArrayView field = trimmed(line.sliced(pos, end - pos));
+        fields[size_t(count)] = field;
+        if (parseNumber(field, &values[size_t(count)])) {
+            ++numbers;
+        } else {
+            names = names && isIdentifier(field);
+        }
+        ++count;
+        if (end == line.size()) {
+            break;
+        }
+        pos = end + 1;
+    }
+
+    if (numbers == count) {
+        for (int column = 0; column < count; ++column) {
+            add(columnChannel(column), values[size_t(column)]);
+        }
+    } else if (numbers == 0 && names && count > 1) {
+        header.resize(size_t(count));
+        for (int column = 0; column < count; ++column) {
+            header[size_t(column)] = channelFor(fields[size_t(column)]);
+        }
+    }
+}
+
+// Devices print their channels in the same order every line, so the cache is searched
+// from just after the previous hit and a steady stream finds each name on the first try
+int TelemetryParser::channelFor(QByteArrayView name) {
+    for (size_t tried = 0; tried < known.size(); ++tried) {
+        const size_t i = (nextKnown + tried) % known.size();
+        if (known[i].name == name) {
+            nextKnown = i + 1;
+            return known[i].channel;
+        }
+    }
+    // Rejected names are not cached: with a filter, any number of them may go by
+    const int channel = allowed(name) ? target->channel(name) : -1;
+    if (channel >= 0) {
+        known.push_back({name.toByteArray(), channel});
+        nextKnown = known.size();
+    }
+    return channel;
+}
+
+int TelemetryParser::columnChannel(int column) {
+    if (size_t(column) < header.size()) {
+        return header[size_t(column)];
+    }
+    while (plainColumns.size() <= size_t(column)) {
+        const QByteArray name = "col" + QByteArray::number(qulonglong(plainColumns.size() + 1));
+        plainColumns.push_back(allowed(name) ? target->channel(name) : -1);
+    }
+    return plainColumns[size_t(column)];
+}
+
+void TelemetryParser::add(int channel, double value) {
+    if (channel < 0) {
+        return;
+    }
+    batch[size_t(batched++)] = {channel, float(value)};
+    ++lineSamples;
+    if (batched == qsizetype(batch.size())) {
+        flush();
+    }
+}
+
+void TelemetryParser::flush() {
+    if (batched == 0) {
+        return;
+    }
+    target->append(batch.data(), batched, timestamp);
+    samples.fetch_add(quint64(batched), std::memory_order_relaxed);
+    batched = 0;
+}
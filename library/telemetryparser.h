@@ -0,0 +1,72 @@
+#ifndef TELEMETRYPARSER_H
+#define TELEMETRYPARSER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "library/telemetrystore.h"
+
+// The TelemetryParser class pulls numeric channels out of a receive stream, line by line,
+// into a TelemetryStore. A line with an = in it is read as key=value pairs separated by
+// spaces, commas or semicolons, such as "temp=21.5 rpm=1200". Any other line is read as
+// CSV, split on commas, semicolons or tabs: a row of identifiers names the columns of the
+// rows that follow, and rows of numbers are samples, in columns col1, col2... if no header
+// has been seen. Values may carry a unit suffix such as 3.3V. Lines that fit neither, like
+// ordinary log text, are skipped. setChannelFilter() limits which names may create
+// channels, so stray key=value text in a log cannot fill the store. Lines are parsed in
+// place, channel names are matched against a cache in the order they last appeared, and
+// samples are batched in a fixed array, so a steady stream is parsed without allocating.
+// Not thread-safe; feed() runs on the session's thread.
+class TelemetryParser
+{
+public:
+    explicit TelemetryParser(TelemetryStore *store);  // Not owned
+
+    void feed(QByteArrayView data, qint64 timestampNs); // timestampNs from a monotonic clock
+    void reset();                 // Drops the partial line and the CSV header
+    void setChannelFilter(const QList<QByteArray> &names); // Only these become channels; empty allows any
+
+    TelemetryStore *store() const;
+    quint64 sampleCount() const;  // Thread-safe
+    quint64 lineCount() const;    // Lines that gave at least one sample
+
+    static constexpr qsizetype MaxLineBytes = 1024; // Longer lines are skipped
+
+private:
+    struct Known {
+        QByteArray name;
+        int channel;
+    };
+
+    void parseLine(QByteArrayView line);
+    void parseKeyValues(QByteArrayView line);
+    void parseCsv(QByteArrayView line);
+    int channelFor(QByteArrayView name);
+    bool allowed(QByteArrayView name) const;
+    int columnChannel(int column);
+    void add(int channel, double value);
+    void flush();
+
+    TelemetryStore *target;
+    QByteArray partial;           // Unfinished line carried into the next feed()
+    bool overlong;                // The current line passed MaxLineBytes
+    qint64 timestamp;
+
+    std::vector<Known> known;     // Names already resolved in the store
+    size_t nextKnown;             // Where the next name is expected to be in known
+    std::vector<int> header;      // CSV column -> channel, from the last header row
+    std::vector<int> plainColumns; // CSV column -> channel colN, for rows without a header
+    std::vector<QByteArray> filter; // Names allowed to create channels; empty allows any
+
+    std::array<TelemetryStore::Sample, 512> batch;
+    qsizetype batched;
+    int lineSamples;
+
+    std::atomic<quint64> samples {0};
+    std::atomic<quint64> lines {0};
+};
+
+#endif // TELEMETRYPARSER_H
@@ -0,0 +1,194 @@
+#include "library/telemetryplot.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+namespace {
+
+QColor channelColor(int channel) {
+    static const QColor colors[] = {QColor(31, 119, 180), QColor(255, 127, 14), QColor(44, 160, 44),
+                                    QColor(214, 39, 40),  QColor(148, 103, 189), QColor(140, 86, 75),
+                                    QColor(227, 119, 194), QColor(23, 190, 207)};
+    const int count = int(sizeof(colors) / sizeof(colors[0]));
+    if (channel < count) {
+        return colors[channel];
+    }
+    return QColor::fromHsv((channel * 47) % 360, 200, 200);
+}
+
+QString spanText(qint64 ns) {
+    if (ns >= 3600LL * 1000000000) {
+        return QString("%1 h").arg(double(ns) / 3600e9, 0, 'g', 3);
+    }
+    if (ns >= 60LL * 1000000000) {
+        return QString("%1 min").arg(double(ns) / 60e9, 0, 'g', 3);
+    }
+    if (ns >= 1000000000) {
+        return QString("%1 s").arg(double(ns) / 1e9, 0, 'g', 3);
+    }
+    return QString("%1 ms").arg(double(ns) / 1e6, 0, 'g', 3);
+}
+
+} // namespace
+
+TelemetryPlot::TelemetryPlot(QWidget *parent)
+    : QWidget(parent), store(nullptr), spanNs(DefaultSpanNs), paintedGeneration(0), refreshTimer(new QTimer(this)) {
+    setAutoFillBackground(true);
+    setBackgroundRole(QPalette::Base);
+    connect(refreshTimer, &QTimer::timeout, this, &TelemetryPlot::refresh);
+}
+
+void TelemetryPlot::setStore(const TelemetryStore *telemetryStore) {
+    store = telemetryStore;
+    update();
+}
+
+void TelemetryPlot::setSpan(qint64 ns) {
+    spanNs = qBound(MinSpanNs, ns, MaxSpanNs);
+    update();
+}
+
+qint64 TelemetryPlot::span() const {
+    return spanNs;
+}
+
+void TelemetryPlot::refresh() {
+    if (store && store->generation() != paintedGeneration) {
+        update();
+    }
+}
+
+void TelemetryPlot::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refreshTimer->start(RefreshMs);
+}
+
+void TelemetryPlot::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    refreshTimer->stop();
+}
+
+void TelemetryPlot::wheelEvent(QWheelEvent *event) {
+    const int steps = event->angleDelta().y() / 120;
+    qint64 span = spanNs;
+    for (int i = 0; i < qAbs(steps); ++i) {
+        span = (steps > 0) ? span / 2 : span * 2;
+    }
+    setSpan(span);
+    event->accept();
+}
+
+void TelemetryPlot::mouseDoubleClickEvent(QMouseEvent *event) {
+    setSpan(DefaultSpanNs);
+    event->accept();
+}
+
+void TelemetryPlot::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    const QFontMetrics metrics = fontMetrics();
+    const QColor textColor = palette().color(QPalette::Text);
+    const QColor dimColor = palette().color(QPalette::PlaceholderText);
+    const int channels = store ? store->channelCount() : 0;
+    if (channels == 0) {
+        painter.setPen(dimColor);
+        painter.drawText(rect(), Qt::AlignCenter, "No telemetry yet: send key=value or CSV lines");
+        return;
+    }
+
+    // The read generation may be a little older than the data decimated below, which only
+    // means one extra repaint
+    paintedGeneration = store->generation();
+    const int lineHeight = metrics.height();
+    const int left = metrics.horizontalAdvance("-0.000e+00") + 8;
+    const int top = lineHeight + 6;
+    const int plotWidth = width() - left - 8;
+    const int plotHeight = height() - top - lineHeight - 6;
+    if (plotWidth < 2 || plotHeight < 2) {
+        return;
+    }
+
+    const qint64 toNs = store->lastTimeNs() + 1;
+    const qint64 fromNs = toNs - spanNs;
+    columns.resize(size_t(channels) * size_t(plotWidth));
+    float low = 0.0f;
+    float high = 0.0f;
+    bool any = false;
+    for (int channel = 0; channel < channels; ++channel) {
+        TelemetryStore::Column *row = columns.data() + size_t(channel) * size_t(plotWidth);
+        store->decimate(channel, fromNs, toNs, row, plotWidth);
+        for (int x = 0; x < plotWidth; ++x) {
+            if (row[x].valid) {
+                low = any ? qMin(low, row[x].min) : row[x].min;
+                high = any ? qMax(high, row[x].max) : row[x].max;
+                any = true;
+            }
+        }
+    }
+    if (high - low < 1e-6f) {
+        low -= 1.0f;
+        high += 1.0f;
+    }
+    const float margin = (high - low) * 0.05f;
+    low -= margin;
+    high += margin;
+
+    const int bottom = top + plotHeight;
+    const double yScale = double(plotHeight) / double(high - low);
+    auto yOf = [&](float value) { return bottom - double(value - low) * yScale; };
+
+    // Frame and axis labels
+    painter.setPen(dimColor);
+    painter.drawRect(left, top, plotWidth - 1, plotHeight - 1);
+    painter.drawText(QRect(0, top - lineHeight / 2, left - 4, lineHeight), Qt::AlignRight | Qt::AlignVCenter,
+                     QString::number(high, 'g', 4));
+    painter.drawText(QRect(0, bottom - lineHeight / 2, left - 4, lineHeight), Qt::AlignRight | Qt::AlignVCenter,
+                     QString::number(low, 'g', 4));
+    painter.drawText(left, bottom + metrics.ascent() + 3, QString("-%1").arg(spanText(spanNs)));
+    painter.drawText(QRect(left, bottom + 3, plotWidth, lineHeight), Qt::AlignRight, "now");
+
+    // A column's stroke runs from its min to its max, plus a join from the previous column
+    // so that a trace sampled less than once per pixel still reads as one line
+    painter.setClipRect(left, top, plotWidth, plotHeight);
+    for (int channel = 0; channel < channels; ++channel) {
+        const TelemetryStore::Column *row = columns.data() + size_t(channel) * size_t(plotWidth);
+        lines.clear();
+        int previous = -1;
+        for (int x = 0; x < plotWidth; ++x) {
+            if (!row[x].valid) {
+                continue;
+            }
+            const double px = left + x + 0.5;
+            if (previous >= 0) {
+                const TelemetryStore::Column &last = row[previous];
+                const double lastX = left + previous + 0.5;
+                if (last.max < row[x].min) {
+                    lines.append(QLineF(lastX, yOf(last.max), px, yOf(row[x].min)));
+                } else if (last.min > row[x].max) {
+                    lines.append(QLineF(lastX, yOf(last.min), px, yOf(row[x].max)));
+                } else if (x - previous > 1) {
+                    lines.append(QLineF(lastX, yOf(last.max), px, yOf(row[x].max)));
+                }
+            }
+            lines.append(QLineF(px, yOf(row[x].min), px, yOf(row[x].max)));
+            previous = x;
+        }
+        painter.setPen(channelColor(channel));
+        painter.drawLines(lines);
+    }
+    painter.setClipping(false);
+
+    // Legend along the top: name and latest value of each channel
+    int x = left;
+    for (int channel = 0; channel < channels; ++channel) {
+        const QString label = QString("%1 %2").arg(store->channelName(channel))
+                                  .arg(store->stats(channel).last, 0, 'g', 6);
+        painter.fillRect(x, 3 + lineHeight / 4, lineHeight / 2, lineHeight / 2, channelColor(channel));
+        x += lineHeight / 2 + 4;
+        painter.setPen(textColor);
+        painter.drawText(x, 3 + metrics.ascent(), label);
+        x += metrics.horizontalAdvance(label) + 12;
+        if (x > width()) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef TELEMETRYPLOT_H
+#define TELEMETRYPLOT_H
+
+#include <QLineF>
+#include <QList>
+#include <QTimer>
+#include <QWidget>
+#include <vector>
+#include "library/telemetrystore.h"
+
+// The TelemetryPlot class draws every channel of a TelemetryStore against time, ending at
+// the newest sample. Each repaint asks the store for one min/max pair per pixel column, so
+// an hour on screen costs the same as a second; each column is drawn as a vertical stroke
+// joined to its neighbour. The y axis fits the visible data. The wheel zooms the time span
+// and a double click restores it. While shown, the plot polls the store on a timer and
+// repaints only when something was appended.
+class TelemetryPlot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TelemetryPlot(QWidget *parent = nullptr);
+
+    void setStore(const TelemetryStore *telemetryStore); // Not owned
+    void setSpan(qint64 ns);                             // Time shown across the plot
+    qint64 span() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    const TelemetryStore *store;
+    qint64 spanNs;
+    quint64 paintedGeneration;               // Store generation of the last repaint
+    QTimer *refreshTimer;
+    std::vector<TelemetryStore::Column> columns; // All channels, one row of plot width each
+    QList<QLineF> lines;                     // Strokes of one channel, reused between repaints
+
+    static constexpr int RefreshMs = 40;
+    static constexpr qint64 DefaultSpanNs = 60LL * 1000000000;
+    static constexpr qint64 MinSpanNs = 100LL * 1000000;
+    // As far back as the default pyramid reaches at 1 kHz
+    static constexpr qint64 MaxSpanNs = TelemetryStore::DefaultLevelCapacity * TelemetryStore::TopBucketSamples
+                                        * 1000000;
+};
+
+#endif // TELEMETRYPLOT_H
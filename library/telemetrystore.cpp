@@ -0,0 +1,208 @@
+#include "library/telemetrystore.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+
+void TelemetryStore::Ring::push(const Point &point) {
+    if (points.size() < size_t(capacity)) {
+        points.push_back(point); // Not yet wrapped, so this lands at index pushed
+    } else {
+        points[size_t(pushed % quint64(capacity))] = point;
+    }
+    ++pushed;
+}
+
+quint64 TelemetryStore::Ring::oldest() const {
+    return pushed > quint64(capacity) ? pushed - quint64(capacity) : 0;
+}
+
+const TelemetryStore::Point &TelemetryStore::Ring::at(quint64 index) const {
+    return points[size_t(index % quint64(capacity))];
+}
+
+quint64 TelemetryStore::Ring::lowerBound(qint64 timeNs) const {
+    quint64 low = oldest();
+    quint64 high = pushed;
+    while (low < high) {
+        const quint64 middle = low + (high - low) / 2;
+        if (at(middle).timeNs < timeNs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+TelemetryStore::TelemetryStore(qsizetype rawCapacity, qsizetype levelCapacity)
+    : rawCapacity(qMax<qsizetype>(LevelFactor, rawCapacity)),
+      levelCapacity(qMax<qsizetype>(LevelFactor, levelCapacity)), newestNs(0) {
+}
+
+int TelemetryStore::channel(QByteArrayView name) {
+    {
+        QReadLocker locker(&lock);
+        for (size_t i = 0; i < channels.size(); ++i) {
+            if (channels[i]->name == name) {
+                return int(i);
+            }
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    if (channels.size() >= size_t(MaxChannels)) {
+        return -1;
+    }
+    auto created = std::make_unique<Channel>();
+    created->name = name.toByteArray();
+    created->rings[0].capacity = rawCapacity;
+    for (int level = 1; level <= Levels; ++level) {
+        created->rings[level].capacity = levelCapacity;
+    }
+    channels.push_back(std::move(created));
+    return int(channels.size() - 1);
+}
+
+void TelemetryStore::append(const Sample *samples, qsizetype count, qint64 timestampNs) {
+    if (count <= 0) {
+        return;
+    }
+    QWriteLocker locker(&lock);
+    // Rings are searched by time, so a timestamp must never go backwards
+    timestampNs = qMax(timestampNs, newestNs);
+    for (qsizetype i = 0; i < count; ++i) {
+        const Sample &sample = samples[i];
+        if (sample.channel < 0 || size_t(sample.channel) >= channels.size()) {
+            continue;
+        }
+        Channel &target = *channels[size_t(sample.channel)];
+        ChannelStats &stats = target.stats;
+        if (stats.samples == 0) {
+            stats.min = stats.max = sample.value;
+        } else {
+            stats.min = qMin<double>(stats.min, sample.value);
+            stats.max = qMax<double>(stats.max, sample.value);
+        }
+        stats.last = sample.value;
+        ++stats.samples;
+        push(target, 0, {timestampNs, sample.value, sample.value});
+    }
+    newestNs = qMax(newestNs, timestampNs);
+    appendCount.fetch_add(1, std::memory_order_release);
+}
+
+// Pushes a point into rings[level] and folds it into the bucket being built for the level above
+void TelemetryStore::push(Channel &channel, int level, const Point &point) {
+    channel.rings[level].push(point);
+    if (level == Levels) {
+        return;
+    }
+    Point &open = channel.open[level];
+    if (channel.openCount[level] == 0) {
+        open = point;
+    } else {
+        open.min = qMin(open.min, point.min);
+        open.max = qMax(open.max, point.max);
+    }
+    if (++channel.openCount[level] == LevelFactor) {
+        channel.openCount[level] = 0;
+        push(channel, level + 1, open);
+    }
+}
+
+void TelemetryStore::clear() {
+    QWriteLocker locker(&lock);
+    for (auto &channel : channels) {
+        for (int level = 0; level <= Levels; ++level) {
+            channel->rings[level].points.clear(); // Keeps the allocation for the next samples
+            channel->rings[level].pushed = 0;
+            channel->openCount[level] = 0;
+        }
+        channel->stats = ChannelStats();
+    }
+    newestNs = 0;
+    appendCount.fetch_add(1, std::memory_order_release);
+}
+
+int TelemetryStore::channelCount() const {
+    QReadLocker locker(&lock);
+    return int(channels.size());
+}
+
+QString TelemetryStore::channelName(int channel) const {
+    QReadLocker locker(&lock);
+    return (channel >= 0 && size_t(channel) < channels.size()) ? QString::fromUtf8(channels[size_t(channel)]->name)
+                                                               : QString();
+}
+
+TelemetryStore::ChannelStats TelemetryStore::stats(int channel) const {
+    QReadLocker locker(&lock);
+    return (channel >= 0 && size_t(channel) < channels.size()) ? channels[size_t(channel)]->stats : ChannelStats();
+}
+
+qint64 TelemetryStore::lastTimeNs() const {
+    QReadLocker locker(&lock);
+    return newestNs;
+}
+
+quint64 TelemetryStore::generation() const {
+    return appendCount.load(std::memory_order_acquire);
+}
+
+int TelemetryStore::decimate(int channel, qint64 fromNs, qint64 toNs, Column *columns, int columnCount) const {
+    if (columnCount <= 0) {
+        return 0;
+    }
+    std::fill(columns, columns + columnCount, Column {0.0f, 0.0f, false});
+    QReadLocker locker(&lock);
+    if (channel < 0 || size_t(channel) >= channels.size() || toNs <= fromNs) {
+        return 0;
+    }
+    const Channel &source = *channels[size_t(channel)];
+
+    // The finest level that still holds fromNs and has at most two points per column.
+    // Failing that, the coarsest level with data, which reaches back furthest.
+    int level = 0;
+    for (; level <= Levels; ++level) {
+        const Ring &ring = source.rings[level];
+        if (ring.pushed == 0) {
+            level = qMax(0, level - 1);
+            break;
+        }
+        const bool complete = ring.oldest() == 0 || ring.at(ring.oldest()).timeNs <= fromNs;
+        const quint64 points = ring.lowerBound(toNs) - ring.lowerBound(fromNs);
+        if (complete && points <= quint64(columnCount) * 2) {
+            break;
+        }
+    }
+    level = qMin(level, int(Levels));
+
+    const double scale = double(columnCount) / double(toNs - fromNs);
+    auto accumulate = [&](const Ring &ring, quint64 index) {
+        for (; index < ring.pushed; ++index) {
+            const Point &point = ring.at(index);
+            if (point.timeNs >= toNs) {
+                break;
+            }
+            if (point.timeNs < fromNs) {
+                continue;
+            }
+            Column &column = columns[qMin(columnCount - 1, int(double(point.timeNs - fromNs) * scale))];
+            if (!column.valid) {
+                column = {point.min, point.max, true};
+            } else {
+                column.min = qMin(column.min, point.min);
+                column.max = qMax(column.max, point.max);
+            }
+        }
+    };
+
+    // Samples newer than the last closed bucket of a level are still in the level below:
+    // closed bucket k of rings[l] covers points [k * LevelFactor, (k + 1) * LevelFactor) of rings[l - 1]
+    accumulate(source.rings[level], source.rings[level].lowerBound(fromNs));
+    for (int below = level - 1; below >= 0; --below) {
+        const Ring &ring = source.rings[below];
+        accumulate(ring, qMax(ring.oldest(), source.rings[below + 1].pushed * LevelFactor));
+    }
+    return level;
+}
@@ -0,0 +1,104 @@
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QReadWriteLock>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// The TelemetryStore class keeps numeric telemetry channels for plotting. Each channel has
+// a fixed-capacity ring of raw samples and a min/max pyramid above it: level 1 holds one
+// bucket per LevelFactor samples, level 2 one per LevelFactor level-1 buckets, and so on,
+// each in its own fixed ring. The higher levels reach back hours after the raw samples have
+// been overwritten. decimate() answers from the finest level that covers the requested span
+// at about one point per column, so its cost follows the view width, not the sample count.
+// Rings grow as samples arrive, up to their capacity; once full, appending never allocates,
+// and a channel that only ever sees a few stray samples costs a few hundred bytes.
+// One writer, usually a TelemetryParser on a session's thread, and any number of readers.
+class TelemetryStore
+{
+public:
+    struct Sample {
+        int channel;
+        float value;
+    };
+
+    struct Column {
+        float min;
+        float max;
+        bool valid;           // False where no sample falls in the column
+    };
+
+    struct ChannelStats {
+        quint64 samples = 0;
+        double min = 0.0;
+        double max = 0.0;
+        double last = 0.0;
+    };
+
+    explicit TelemetryStore(qsizetype rawCapacity = DefaultRawCapacity, qsizetype levelCapacity = DefaultLevelCapacity);
+
+    // Writer side
+    int channel(QByteArrayView name);     // Created on first use; -1 once MaxChannels exist
+    void append(const Sample *samples, qsizetype count, qint64 timestampNs); // Monotonic; never earlier than the last
+    void clear();                         // Drops all samples but keeps the channels
+
+    // Reader side; thread-safe
+    int channelCount() const;
+    QString channelName(int channel) const;
+    ChannelStats stats(int channel) const;
+    qint64 lastTimeNs() const;            // Newest sample of any channel, 0 if none
+    quint64 generation() const;           // Changes on every append, so views can skip idle repaints
+
+    // Min and max of the channel in each of columnCount equal slices of [fromNs, toNs).
+    // Returns the pyramid level used, 0 for raw samples.
+    int decimate(int channel, qint64 fromNs, qint64 toNs, Column *columns, int columnCount) const;
+
+    static constexpr int MaxChannels = 64;
+    static constexpr int LevelFactor = 8;
+    static constexpr int Levels = 5;       // Above the raw samples
+    static constexpr qsizetype DefaultRawCapacity = 1 << 16;   // About a minute at 1 kHz
+    static constexpr qsizetype DefaultLevelCapacity = 1 << 14; // Level 5 spans 6.2 days at 1 kHz
+    static constexpr qint64 TopBucketSamples = qint64(1) << (3 * Levels); // LevelFactor^Levels
+
+private:
+    // A raw sample has min == max; a bucket starts at the time of its first sample
+    struct Point {
+        qint64 timeNs;
+        float min;
+        float max;
+    };
+
+    struct Ring {
+        std::vector<Point> points;        // Grows to capacity, then wraps
+        qsizetype capacity = 0;
+        quint64 pushed = 0;               // Points ever pushed; the newest has index pushed - 1
+
+        void push(const Point &point);
+        quint64 oldest() const;           // Index of the oldest point still held
+        const Point &at(quint64 index) const;
+        quint64 lowerBound(qint64 timeNs) const; // First held index at or after timeNs
+    };
+
+    struct Channel {
+        QByteArray name;
+        Ring rings[Levels + 1];           // rings[0] is raw, rings[k] has buckets of LevelFactor^k samples
+        Point open[Levels + 1];           // Bucket being filled for rings[k + 1]
+        int openCount[Levels + 1] = {};
+        ChannelStats stats;
+    };
+
+    void push(Channel &channel, int level, const Point &point);
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    qsizetype rawCapacity;
+    qsizetype levelCapacity;
+    qint64 newestNs;
+    std::atomic<quint64> appendCount {0};
+    mutable QReadWriteLock lock;
+};
+
+#endif // TELEMETRYSTORE_H
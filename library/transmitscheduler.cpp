@@ -0,0 +1,407 @@
+#include "library/transmitscheduler.h"
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "library/escapedtext.h"
+#ifdef Q_OS_LINUX
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+// steady_clock is CLOCK_MONOTONIC on Linux, the timerfd's clock, so deadlines can be
+// handed to the timer as absolute times
+static qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace {
+
+QString readWord(const QString &text, qsizetype &pos) {
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+    const qsizetype start = pos;
+    while (pos < text.size() && !text[pos].isSpace()) {
+        ++pos;
+    }
+    return text.mid(start, pos - start);
+}
+
+// 10ms, 2.5s, 250us, 100ns
+bool parseDuration(const QString &word, qint64 *ns) {
+    static const QList<QPair<QString, double>> units = {{"ns", 1.0}, {"us", 1e3}, {"ms", 1e6}, {"s", 1e9}};
+    for (const auto &unit : units) {
+        // Two-letter units come first, so 10ms is never read as 10m seconds
+        if (word.endsWith(unit.first)) {
+            bool ok = false;
+            const double value = word.chopped(unit.first.size()).toDouble(&ok);
+            if (!ok || value < 0) {
+                return false;
+            }
+            *ns = qint64(value * unit.second + 0.5);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool fail(QString *error, const QString &message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+} // namespace
+
+TransmitScheduler::TransmitScheduler(QObject *parent)
+    : QObject(parent), target(nullptr), running(false), startNs(0), threshold(DefaultMissThresholdNs),
+      historyCapacity(DefaultHistoryCapacity), historyNext(0), timerFd(-1), notifier(nullptr),
+      fallbackTimer(new QTimer(this)) {
+    fallbackTimer->setSingleShot(true);
+    fallbackTimer->setTimerType(Qt::PreciseTimer);
+    connect(fallbackTimer, &QTimer::timeout, this, &TransmitScheduler::runDue);
+    openTimer();
+}
+
+TransmitScheduler::~TransmitScheduler() {
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0) {
+        delete notifier;
+        ::close(timerFd);
+    }
+#endif
+}
+
+bool TransmitScheduler::openTimer() {
+#ifdef Q_OS_LINUX
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        return false;
+    }
+    // A child, so it follows the scheduler to the target's thread
+    notifier = new QSocketNotifier(timerFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &TransmitScheduler::runDue);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TransmitScheduler::setTarget(FirmwareUART *uart) {
+    stop();
+    target = uart;
+}
+
+int TransmitScheduler::addPeriodic(const QByteArray &payload, qint64 periodNs, qint64 offsetNs, quint64 count) {
+    if (running || payload.isEmpty() || periodNs < minimumPeriod()) {
+        return -1;
+    }
+    entries.append({payload, periodNs, offsetNs, qMax<qint64>(0, offsetNs), count, count, false, EntryStats()});
+    return int(entries.size() - 1);
+}
+
+int TransmitScheduler::addOneShot(const QByteArray &payload, qint64 atNs) {
+    if (running || payload.isEmpty()) {
+        return -1;
+    }
+    entries.append({payload, 0, atNs, qMax<qint64>(0, atNs), 1, 1, false, EntryStats()});
+    return int(entries.size() - 1);
+}
+
+void TransmitScheduler::clear() {
+    stop();
+    entries.clear();
+    history.clear();
+    historyNext = 0;
+}
+
+int TransmitScheduler::entryCount() const {
+    return int(entries.size());
+}
+
+qint64 TransmitScheduler::minimumPeriod() const {
+    return (timerFd >= 0) ? SpinNs : FallbackSpinNs;
+}
+
+bool TransmitScheduler::addRule(const QString &rule, QString *error) {
+    const QString text = rule.trimmed();
+    qsizetype pos = 0;
+    const QString kind = readWord(text, pos).toLower();
+
+    qint64 periodNs = 0;
+    qint64 offsetNs = 0;
+    quint64 count = 0;
+    if (kind == "every") {
+        if (!parseDuration(readWord(text, pos), &periodNs) || periodNs <= 0) {
+            return fail(error, "every needs a period such as 10ms");
+        }
+        if (periodNs < minimumPeriod()) {
+            return fail(error, QString("the period must be at least %1us").arg(minimumPeriod() / 1000));
+        }
+        for (;;) {
+            const qsizetype wordStart = pos;
+            const QString word = readWord(text, pos).toLower();
+            if (word == "after") {
+                if (!parseDuration(readWord(text, pos), &offsetNs)) {
+                    return fail(error, "after needs a duration such as 5ms");
+                }
+            } else if (word == "times") {
+                bool ok = false;
+                count = readWord(text, pos).toULongLong(&ok);
+                if (!ok || count == 0) {
+                    return fail(error, "times needs a positive count");
+                }
+            } else {
+                pos = wordStart;
+                break;
+            }
+        }
+    } else if (kind == "at") {
+        if (!parseDuration(readWord(text, pos), &offsetNs)) {
+            return fail(error, "at needs a time such as 5s");
+        }
+    } else {
+        return fail(error, "rules start with every or at");
+    }
+
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+    QByteArray payload;
+    if (pos < text.size() && text[pos] == '"') {
+        if (!readQuotedBytes(text, pos, &payload)) {
+            return fail(error, "unterminated or invalid payload");
+        }
+    } else if (!readHexBytes(text, pos, &payload)) {
+        return fail(error, "payload must be \"quoted\" or hex:...");
+    }
+    if (pos < text.size()) {
+        return fail(error, "unexpected text after the payload");
+    }
+    if (payload.isEmpty()) {
+        return fail(error, "empty payload");
+    }
+
+    const int id = (kind == "every") ? addPeriodic(payload, periodNs, offsetNs, count) : addOneShot(payload, offsetNs);
+    return id >= 0 || fail(error, "the schedule is running");
+}
+
+bool TransmitScheduler::loadSchedule(const QString &filePath, QString *error) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return fail(error, file.errorString());
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QString rule = QString::fromUtf8(file.readLine()).trimmed();
+        ++lineNumber;
+        if (rule.isEmpty() || rule.startsWith('#')) {
+            continue;
+        }
+        QString message;
+        if (!addRule(rule, &message)) {
+            return fail(error, QString("line %1: %2").arg(lineNumber).arg(message));
+        }
+    }
+    return true;
+}
+
+void TransmitScheduler::setMissThreshold(qint64 ns) {
+    threshold = qMax<qint64>(0, ns);
+}
+
+qint64 TransmitScheduler::missThreshold() const {
+    return threshold;
+}
+
+void TransmitScheduler::setHistoryCapacity(int sends) {
+    historyCapacity = qMax(1, sends);
+    history.clear();
+    historyNext = 0;
+}
+
+bool TransmitScheduler::isRunning() const {
+    return running;
+}
+
+TransmitScheduler::EntryStats TransmitScheduler::entryStats(int id) const {
+    return (id >= 0 && id < entries.size()) ? entries[id].stats : EntryStats();
+}
+
+qint64 TransmitScheduler::latenessPercentile(int id, int percent) const {
+    std::vector<qint64> lateness;
+    for (const Send &send : history) {
+        if (send.entry == id) {
+            lateness.push_back(send.sentNs - send.dueNs);
+        }
+    }
+    if (lateness.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(lateness.size() - 1, lateness.size() * size_t(qBound(0, percent, 100)) / 100);
+    std::nth_element(lateness.begin(), lateness.begin() + qsizetype(index), lateness.end());
+    return lateness[index];
+}
+
+QList<TransmitScheduler::Send> TransmitScheduler::sendLog() const {
+    if (history.size() < historyCapacity) {
+        return history;
+    }
+    return history.mid(historyNext) + history.mid(0, historyNext);
+}
+
+bool TransmitScheduler::start() {
+    stop();
+    if (!target || !target->isConnected() || entries.isEmpty()) {
+        return false;
+    }
+
+    for (Entry &entry : entries) {
+        entry.nextDueNs = entry.firstDueNs;
+        entry.remaining = entry.count;
+        entry.done = false;
+        entry.stats = EntryStats();
+    }
+    history.clear();
+    history.reserve(qMin(historyCapacity, 4096));
+    historyNext = 0;
+
+    startNs = monotonicNs();
+    running = true;
+    runDue();
+    return true;
+}
+
+void TransmitScheduler::stop() {
+    running = false;
+    fallbackTimer->stop();
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0) {
+        const itimerspec disarm = {};
+        timerfd_settime(timerFd, 0, &disarm, nullptr);
+    }
+#endif
+}
+
+qint64 TransmitScheduler::elapsedNs() const {
+    return monotonicNs() - startNs;
+}
+
+void TransmitScheduler::arm(qint64 dueNs) {
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0) {
+        const qint64 at = startNs + dueNs;
+        itimerspec spec = {};
+        spec.it_value.tv_sec = time_t(at / 1000000000);
+        spec.it_value.tv_nsec = long(at % 1000000000);
+        timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        return;
+    }
+#endif
+    fallbackTimer->start(int(qMax<qint64>(0, (dueNs - elapsedNs()) / 1000000)));
+}
+
+void TransmitScheduler::runDue() {
+#ifdef Q_OS_LINUX
+    if (timerFd >= 0) {
+        quint64 expirations;
+        while (::read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+    }
+#endif
+    const qint64 spinNs = minimumPeriod();
+
+    bool wrote = false;
+    while (running) {
+        qint64 due = -1;
+        for (const Entry &entry : std::as_const(entries)) {
+            if (!entry.done && (due < 0 || entry.nextDueNs < due)) {
+                due = entry.nextDueNs;
+            }
+        }
+        if (due < 0) {
+            running = false;
+            emit finished();
+            return;
+        }
+
+        // One spin per wake-up; the next deadline, however close, waits for the event loop
+        qint64 now = elapsedNs();
+        if (wrote || due - now > spinNs) {
+            arm(due - spinNs);
+            return;
+        }
+        while (now < due) {
+            now = elapsedNs();
+        }
+
+        // Everything due by now goes out in one write, stamped with the same send time
+        QByteArray batch;
+        batchDue.clear();
+        for (int id = 0; id < entries.size(); ++id) {
+            Entry &entry = entries[id];
+            if (entry.done || entry.nextDueNs > now) {
+                continue;
+            }
+            if (entry.periodNs > 0 && now - entry.nextDueNs >= entry.periodNs) {
+                quint64 behind = quint64((now - entry.nextDueNs) / entry.periodNs);
+                if (entry.count > 0) {
+                    behind = qMin(behind, entry.remaining);
+                    entry.remaining -= behind;
+                }
+                entry.stats.skipped += behind;
+                entry.nextDueNs += qint64(behind) * entry.periodNs;
+                if (entry.count > 0 && entry.remaining == 0) {
+                    entry.done = true;
+                    continue;
+                }
+            }
+
+            batch += entry.payload;
+            batchDue.append({id, entry.nextDueNs});
+            entry.nextDueNs += entry.periodNs;
+            if (entry.count > 0 && --entry.remaining == 0) {
+                entry.done = true;
+            }
+        }
+        if (batch.isEmpty()) {
+            continue;
+        }
+        if (!target->writeData(batch)) {
+            stop();
+            emit finished();
+            return;
+        }
+        // writeData() only queues; the send time is when the bytes reach the driver
+        target->flushTransmit();
+        const qint64 sentNs = elapsedNs();
+        for (const auto &sent : std::as_const(batchDue)) {
+            record(sent.first, sent.second, sentNs);
+        }
+        wrote = true;
+    }
+}
+
+void TransmitScheduler::record(int id, qint64 dueNs, qint64 sentNs) {
+    EntryStats &stats = entries[id].stats;
+    const qint64 lateness = sentNs - dueNs;
+    ++stats.sent;
+    stats.totalLatenessNs += lateness;
+    stats.maxLatenessNs = qMax(stats.maxLatenessNs, lateness);
+    if (lateness > threshold) {
+        ++stats.late;
+    }
+
+    const Send send = {id, dueNs, sentNs};
+    if (history.size() < historyCapacity) {
+        history.append(send);
+    } else {
+        history[historyNext] = send;
+        historyNext = (historyNext + 1) % historyCapacity;
+    }
+}
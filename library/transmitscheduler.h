@@ -0,0 +1,120 @@
+#ifndef TRANSMITSCHEDULER_H
+#define TRANSMITSCHEDULER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+#include "library/firmwareuart.h"
+
+// The TransmitScheduler class sends prepared payloads through a FirmwareUART on a fixed
+// timetable: periodic entries with an optional start offset and repeat count, and one-shot
+// entries at a set time. Every deadline is computed from the time start() was called, so
+// timer jitter never accumulates. On Linux the wake-ups come from an absolute-time timerfd
+// watched on the target's own thread; elsewhere a precise QTimer stands in. Either way the
+// last SpinNs before a deadline are busy-waited, once per wake-up: after each write the
+// scheduler returns to the event loop, so the port and its signals keep being serviced.
+// Periods shorter than the spin are refused. Entries due together go out as one write.
+// Each send is recorded with its due and actual time, where actual means flushed to the
+// driver. A periodic entry that falls a whole period behind skips the sends it missed rather
+// than bursting them; they count as missed deadlines, as do sends later than the threshold.
+// The scheduler must live on the target's thread.
+class TransmitScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Send {
+        int entry;
+        qint64 dueNs;         // Both relative to start()
+        qint64 sentNs;
+    };
+
+    struct EntryStats {
+        quint64 sent = 0;
+        quint64 late = 0;             // Sent later than the miss threshold
+        quint64 skipped = 0;          // Not sent at all because the entry fell a period behind
+        qint64 totalLatenessNs = 0;
+        qint64 maxLatenessNs = 0;
+        quint64 missed() const { return late + skipped; }
+        qint64 meanLatenessNs() const { return sent ? totalLatenessNs / qint64(sent) : 0; }
+    };
+
+    explicit TransmitScheduler(QObject *parent = nullptr);
+    ~TransmitScheduler();
+
+    void setTarget(FirmwareUART *uart);           // Not owned
+
+    // Entries cannot change while running. count 0 repeats until stop(). A period must be at
+    // least minimumPeriod().
+    int addPeriodic(const QByteArray &payload, qint64 periodNs, qint64 offsetNs = 0, quint64 count = 0);
+    int addOneShot(const QByteArray &payload, qint64 atNs);
+    void clear();
+    int entryCount() const;
+    qint64 minimumPeriod() const;                 // The busy-wait before each deadline
+
+    // Schedule lines: every <period> [after <offset>] [times <n>] <payload>, or at <time> <payload>.
+    // Durations take ns, us, ms or s; payloads are "quoted" or hex:..., as in escapedtext.h.
+    // Blank lines and lines starting with # are skipped.
+    bool addRule(const QString &rule, QString *error = nullptr);
+    bool loadSchedule(const QString &filePath, QString *error = nullptr);
+
+    void setMissThreshold(qint64 ns);
+    qint64 missThreshold() const;
+    void setHistoryCapacity(int sends);           // Most recent sends kept by sendLog()
+
+    bool isRunning() const;
+    EntryStats entryStats(int id) const;
+    qint64 latenessPercentile(int id, int percent) const; // Over the sends still in sendLog()
+    QList<Send> sendLog() const;                  // Oldest first
+
+public slots:
+    bool start();
+    void stop();
+
+signals:
+    void finished();                              // Every entry has run its course, or the port refused a write
+
+private slots:
+    void runDue();
+
+private:
+    struct Entry {
+        QByteArray payload;
+        qint64 periodNs;      // 0 for a one-shot
+        qint64 nextDueNs;
+        qint64 firstDueNs;
+        quint64 count;        // Sends in total, 0 for no limit
+        quint64 remaining;
+        bool done;
+        EntryStats stats;
+    };
+
+    bool openTimer();
+    void arm(qint64 dueNs);                       // Relative to start()
+    qint64 elapsedNs() const;
+    void record(int id, qint64 dueNs, qint64 sentNs);
+
+    FirmwareUART *target;
+    QList<Entry> entries;
+    bool running;
+    qint64 startNs;           // Monotonic clock at start()
+    qint64 threshold;
+
+    QList<QPair<int, qint64>> batchDue; // Entry and due time of each payload in the write being built
+    QList<Send> history;      // Ring of the last historyCapacity sends
+    int historyCapacity;
+    int historyNext;
+
+    int timerFd;
+    QSocketNotifier *notifier;
+    QTimer *fallbackTimer;
+
+    static constexpr qint64 SpinNs = 200000;              // Covers wake-up latency; the rest is slept
+    static constexpr qint64 FallbackSpinNs = 1200000;     // QTimer has millisecond resolution
+    static constexpr qint64 DefaultMissThresholdNs = 1000000;
+    static constexpr int DefaultHistoryCapacity = 100000;
+};
+
+#endif // TRANSMITSCHEDULER_H
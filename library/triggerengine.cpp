@@ -0,0 +1,353 @@
+#include "library/triggerengine.h"
+#include <QFile>
+#include "library/escapedtext.h"
+#include <cstring>
+
+namespace {
+
+// Reads /.../ starting at text[pos]. Escapes are left for QRegularExpression, which reads \/ as /.
+bool readRegex(const QString &text, qsizetype &pos, QByteArray *out) {
+    const qsizetype start = ++pos;
+    while (pos < text.size()) {
+        if (text[pos] == '\\') {
+            pos += 2;
+        } else if (text[pos] == '/') {
+            *out = text.mid(start, pos - start).toUtf8();
+            ++pos;
+            return true;
+        } else {
+            ++pos;
+        }
+    }
+    return false;
+}
+
+bool fail(QString *error, const QString &message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+bool isLineAction(TriggerEngine::Action action) {
+    return action == TriggerEngine::Action::Highlight || action == TriggerEngine::Action::Hide
+           || action == TriggerEngine::Action::Show;
+}
+
+// Lines are matched as Latin-1, one character per byte, so the pattern is read the same way:
+// a UTF-8 sequence in a rule then matches the same bytes arriving on the port
+QRegularExpression patternRegex(const TriggerEngine::Trigger &trigger) {
+    return QRegularExpression(QString::fromLatin1(trigger.pattern), trigger.ignoreCase
+                                  ? QRegularExpression::CaseInsensitiveOption
+                                  : QRegularExpression::NoPatternOption);
+}
+
+} // namespace
+
+bool TriggerEngine::parseRule(const QString &rule, Trigger *trigger, QString *error) {
+    const QString text = rule.trimmed();
+    qsizetype pos = 0;
+    while (pos < text.size() && !text[pos].isSpace() && text[pos] != '=') {
+        ++pos;
+    }
+    const QString action = text.left(pos).toLower();
+
+    // The argument is quoted bytes for respond, or a bare word such as a colour name
+    QByteArray argument;
+    bool hasArgument = false;
+    if (pos < text.size() && text[pos] == '=') {
+        hasArgument = true;
+        ++pos;
+        if (pos < text.size() && text[pos] == '"') {
+            if (!readQuotedBytes(text, pos, &argument)) {
+                return fail(error, "unterminated or invalid argument");
+            }
+        } else if (text.mid(pos, 4).compare("hex:", Qt::CaseInsensitive) == 0) {
+            if (!readHexBytes(text, pos, &argument)) {
+                return fail(error, "invalid hex argument");
+            }
+        } else {
+            const qsizetype start = pos;
+            while (pos < text.size() && !text[pos].isSpace()) {
+                ++pos;
+            }
+            argument = text.mid(start, pos - start).toUtf8();
+        }
+    }
+
+    Trigger result;
+    if (action == "count") {
+        result.action = Action::Count;
+    } else if (action == "hide") {
+        result.action = Action::Hide;
+    } else if (action == "show") {
+        result.action = Action::Show;
+    } else if (action == "highlight") {
+        result.action = Action::Highlight;
+        result.color = hasArgument ? QString::fromUtf8(argument) : QString("yellow");
+    } else if (action == "respond") {
+        if (!hasArgument) {
+            return fail(error, "respond needs a response, as in respond=\"y\\r\"");
+        }
+        result.action = Action::Respond;
+        result.response = argument;
+    } else {
+        return fail(error, "unknown action '" + action + "'");
+    }
+
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+    const qsizetype patternStart = pos;
+    if (pos < text.size() && text[pos] == '"') {
+        if (!readQuotedBytes(text, pos, &result.pattern)) {
+            return fail(error, "unterminated or invalid pattern");
+        }
+    } else if (text.mid(pos, 4).compare("hex:", Qt::CaseInsensitive) == 0) {
+        if (!readHexBytes(text, pos, &result.pattern)) {
+            return fail(error, "invalid hex pattern");
+        }
+    } else if (pos < text.size() && text[pos] == '/') {
+        result.regex = true;
+        if (!readRegex(text, pos, &result.pattern)) {
+            return fail(error, "unterminated regex");
+        }
+    } else {
+        return fail(error, "pattern must be \"quoted\", hex:... or a /regex/");
+    }
+    if (pos < text.size() && text[pos] == 'i') {
+        result.ignoreCase = true;
+        ++pos;
+    }
+    if (pos < text.size()) {
+        return fail(error, "unexpected text after the pattern");
+    }
+    if (result.pattern.isEmpty()) {
+        return fail(error, "empty pattern");
+    }
+
+    result.name = text.mid(patternStart);
+    *trigger = result;
+    return true;
+}
+
+bool TriggerEngine::loadRules(const QString &filePath, QString *error) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return fail(error, file.errorString());
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QString rule = QString::fromUtf8(file.readLine()).trimmed();
+        ++lineNumber;
+        if (rule.isEmpty() || rule.startsWith('#')) {
+            continue;
+        }
+        Trigger trigger;
+        QString message;
+        if (!parseRule(rule, &trigger, &message) || addTrigger(trigger, &message) < 0) {
+            return fail(error, QString("line %1: %2").arg(lineNumber).arg(message));
+        }
+    }
+    return true;
+}
+
+int TriggerEngine::addTrigger(const Trigger &trigger, QString *error) {
+    if (compiled) {
+        fail(error, "triggers cannot be added after compile()");
+        return -1;
+    }
+    if (trigger.pattern.isEmpty()) {
+        fail(error, "empty pattern");
+        return -1;
+    }
+    if (trigger.regex) {
+        const QRegularExpression regex = patternRegex(trigger);
+        if (!regex.isValid()) {
+            fail(error, regex.errorString());
+            return -1;
+        }
+    }
+
+    triggerList.append(trigger);
+    if (triggerList.last().name.isEmpty()) {
+        triggerList.last().name = QString::fromUtf8(trigger.pattern);
+    }
+    return int(triggerList.size() - 1);
+}
+
+int TriggerEngine::triggerCount() const {
+    return int(triggerList.size());
+}
+
+const TriggerEngine::Trigger &TriggerEngine::trigger(int id) const {
+    return triggerList[id];
+}
+
+bool TriggerEngine::compile() {
+    if (compiled) {
+        return true;
+    }
+    if (triggerList.isEmpty()) {
+        return false;
+    }
+
+    for (int id = 0; id < triggerList.size(); ++id) {
+        const Trigger &trigger = triggerList[id];
+        if (trigger.regex) {
+            QRegularExpression regex = patternRegex(trigger);
+            regex.optimize(); // JIT-compile now rather than on the first line
+            regexes.append(regex);
+            regexTriggers.append(id);
+        } else {
+            matcher.addPattern(trigger.pattern, trigger.ignoreCase);
+            literalTriggers.append(id);
+        }
+        lineActions = lineActions || isLineAction(trigger.action);
+        showFilter = showFilter || trigger.action == Action::Show;
+    }
+    if (!literalTriggers.isEmpty() && !matcher.compile()) {
+        return false;
+    }
+    matcher.setMatchHandler([this](int pattern, qint64 offset) {
+        count(literalTriggers[pattern], offset);
+    });
+
+    counts = std::make_unique<std::atomic<quint64>[]>(size_t(triggerList.size()));
+    compiled = true;
+    return true;
+}
+
+bool TriggerEngine::isCompiled() const {
+    return compiled;
+}
+
+int TriggerEngine::stateCount() const {
+    return matcher.isCompiled() ? matcher.stateCount() : 0;
+}
+
+void TriggerEngine::setMatchHandler(MatchHandler handler) {
+    this->handler = std::move(handler);
+}
+
+void TriggerEngine::feed(QByteArrayView data, qint64 timestampNs) {
+    if (!compiled || data.isEmpty()) {
+        return;
+    }
+    chunkTimestampNs = timestampNs;
+    if (!literalTriggers.isEmpty()) {
+        matcher.feed(data);
+    }
+
+    // Whole lines are matched in place; only the unfinished start of a line is copied
+    if (!regexTriggers.isEmpty()) {
+        qsizetype start = 0;
+        while (start < data.size()) {
+            const char *newline = static_cast<const char *>(
+                std::memchr(data.data() + start, '\n', size_t(data.size() - start)));
+            const qsizetype end = newline ? newline - data.data() : data.size();
+            if (line.isEmpty()) {
+                lineOffset = streamOffset + start;
+            }
+            if (newline && line.isEmpty()) {
+                matchLine(data.sliced(start, end - start), lineOffset);
+            } else {
+                line.append(data.sliced(start, end - start));
+                if (newline || line.size() >= MaxLineBytes) {
+                    matchLine(line, lineOffset);
+                    line.clear();
+                }
+            }
+            start = end + 1;
+        }
+    }
+    streamOffset += data.size();
+}
+
+void TriggerEngine::matchLine(QByteArrayView text, qint64 offset) {
+    qsizetype pos = 0;
+    do {
+        QByteArrayView piece = text.sliced(pos, qMin(MaxLineBytes, text.size() - pos));
+        if (piece.endsWith('\r')) {
+            piece.chop(1);
+        }
+        const QString latin1 = QString::fromLatin1(piece);
+        for (int i = 0; i < regexes.size(); ++i) {
+            QRegularExpressionMatchIterator matches = regexes[i].globalMatch(latin1);
+            while (matches.hasNext()) {
+                count(regexTriggers[i], offset + pos + matches.next().capturedStart());
+            }
+        }
+        pos += MaxLineBytes;
+    } while (pos < text.size());
+}
+
+void TriggerEngine::count(int id, qint64 offset) {
+    counts[size_t(id)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    if (handler) {
+        handler(id, offset, chunkTimestampNs);
+    }
+}
+
+void TriggerEngine::reset() {
+    matcher.reset();
+    line.clear();
+    lineOffset = 0;
+    streamOffset = 0;
+}
+
+quint64 TriggerEngine::matchCount(int id) const {
+    return compiled && id >= 0 && id < triggerList.size() ? counts[size_t(id)].load(std::memory_order_relaxed) : 0;
+}
+
+quint64 TriggerEngine::totalMatches() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+bool TriggerEngine::hasLineActions() const {
+    return lineActions;
+}
+
+TriggerEngine::LineStyle TriggerEngine::classifyLine(QByteArrayView line) const {
+    LineStyle style;
+    if (!compiled || !lineActions) {
+        return style;
+    }
+
+    bool hide = false;
+    bool shown = !showFilter;
+    int highlight = -1; // The earliest Highlight trigger wins
+    auto apply = [&](int id) {
+        switch (triggerList[id].action) {
+        case Action::Hide:
+            hide = true;
+            break;
+        case Action::Show:
+            shown = true;
+            break;
+        case Action::Highlight:
+            highlight = (highlight < 0) ? id : qMin(highlight, id);
+            break;
+        default:
+            break;
+        }
+    };
+
+    matcher.scan(line, [&](int pattern, qint64) { apply(literalTriggers[pattern]); });
+    if (!regexes.isEmpty()) {
+        const QString latin1 = QString::fromLatin1(line);
+        for (int i = 0; i < regexes.size(); ++i) {
+            if (isLineAction(triggerList[regexTriggers[i]].action) && regexes[i].match(latin1).hasMatch()) {
+                apply(regexTriggers[i]);
+            }
+        }
+    }
+
+    style.hidden = hide || !shown;
+    if (highlight >= 0 && !style.hidden) {
+        style.highlight = triggerList[highlight].color;
+    }
+    return style;
+}
@@ -0,0 +1,100 @@
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "library/patternmatcher.h"
+
+// The TriggerEngine class watches a receive stream for a set of triggers and reports each
+// match with its stream offset and the arrival time of the read that completed it.
+// Literal triggers all share one PatternMatcher pass over the raw bytes and may span reads.
+// Regex triggers run on whole lines, read as Latin-1 so that offsets stay byte offsets;
+// they are reported when the line ends, so events are not always in offset order.
+// Triggers are fixed once compile() succeeds; feed() runs on the session's thread, while
+// the counters and classifyLine() may be used from any thread.
+class TriggerEngine
+{
+public:
+    enum class Action {
+        Count,      // Only report and count the match
+        Highlight,  // Console shows the line with the trigger's colour behind it
+        Hide,       // Console drops the line
+        Show,       // Console shows only lines that match some Show trigger
+        Respond     // Session writes the trigger's response as soon as the match completes
+    };
+
+    struct Trigger {
+        QString name;         // Shown in events; defaults to the rule's pattern text
+        QByteArray pattern;
+        bool regex = false;
+        bool ignoreCase = false;
+        Action action = Action::Count;
+        QByteArray response;  // For Respond
+        QString color;        // For Highlight, any name QColor accepts
+    };
+
+    struct LineStyle {
+        bool hidden = false;
+        QString highlight;    // Empty when no Highlight trigger matched
+    };
+
+    using MatchHandler = std::function<void(int trigger, qint64 offset, qint64 timestampNs)>;
+
+    TriggerEngine() = default;
+
+    // Rules, one per line: <action>[=<argument>] <pattern>. Actions are count, hide, show,
+    // highlight=<colour> and respond=<bytes>. A pattern is "literal", hex:0d0a or /regex/,
+    // optionally followed by i to ignore case. Bytes are written as in escapedtext.h.
+    // Blank lines and lines starting with # are skipped.
+    static bool parseRule(const QString &rule, Trigger *trigger, QString *error = nullptr);
+    bool loadRules(const QString &filePath, QString *error = nullptr);
+
+    int addTrigger(const Trigger &trigger, QString *error = nullptr); // Returns the id, or -1
+    int triggerCount() const;
+    const Trigger &trigger(int id) const;
+    bool compile();               // Call once all triggers are added; false if there are none
+    bool isCompiled() const;
+    int stateCount() const;       // Size of the literal triggers' automaton
+
+    void setMatchHandler(MatchHandler handler);
+    void feed(QByteArrayView data, qint64 timestampNs);
+    void reset();                 // Back to the start of a stream; counters are kept
+
+    quint64 matchCount(int id) const;   // Thread-safe
+    quint64 totalMatches() const;
+
+    // Console filtering for one complete line, without the line ending
+    bool hasLineActions() const;
+    LineStyle classifyLine(QByteArrayView line) const;
+
+    static constexpr qsizetype MaxLineBytes = 4096; // Longer lines are split for regex triggers
+
+private:
+    void matchLine(QByteArrayView text, qint64 offset);
+    void count(int id, qint64 offset);
+
+    QList<Trigger> triggerList;
+    QList<int> literalTriggers;         // PatternMatcher pattern id -> trigger id
+    QList<int> regexTriggers;
+    QList<QRegularExpression> regexes;  // Parallel to regexTriggers
+    PatternMatcher matcher;
+    bool compiled = false;
+    bool lineActions = false;
+    bool showFilter = false;            // Some trigger has Action::Show
+
+    MatchHandler handler;
+    QByteArray line;                    // Start of the current line, kept for regex triggers
+    qint64 lineOffset = 0;              // Stream offset of line[0]
+    qint64 streamOffset = 0;
+    qint64 chunkTimestampNs = 0;        // Arrival time of the data being fed
+    std::unique_ptr<std::atomic<quint64>[]> counts;
+    std::atomic<quint64> total {0};
+};
+
+#endif // TRIGGERENGINE_H
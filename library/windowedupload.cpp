@@ -0,0 +1,269 @@
+#include "library/windowedupload.h"
+#include <QFileInfo>
+#include <QtEndian>
+#include "library/crc.h"
+
+static QByteArray header(quint8 type, quint32 value) {
+    QByteArray message(5, Qt::Uninitialized);
+    message[0] = char(type);
+    qToLittleEndian<quint32>(value, message.data() + 1);
+    return message;
+}
+
+WindowedUpload::WindowedUpload(QObject *parent)
+    : QObject(parent), target(nullptr), previousDecoder(nullptr), decoder(FrameDecoder::Checksum::Crc32),
+      imageFile(nullptr), imageMapping(nullptr), state(State::Idle), blockBytes(DefaultBlockSize),
+      windowBlocks(DefaultWindow), timeoutMs(DefaultTimeoutMs), maxRetries(DefaultMaxRetries), retries(0),
+      base(0), next(0), lastNak(NoNak), imageCrc(0), retransmitted(0), timer(new QTimer(this)) {
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &WindowedUpload::handleTimeout);
+}
+
+WindowedUpload::~WindowedUpload() {
+    cancel();
+}
+
+void WindowedUpload::setTarget(FirmwareUART *uart) {
+    cancel();
+    target = uart;
+}
+
+void WindowedUpload::setBlockSize(int bytes) {
+    blockBytes = qBound(16, bytes, 32 * 1024);
+}
+
+int WindowedUpload::blockSize() const {
+    return blockBytes;
+}
+
+void WindowedUpload::setWindow(int blocks) {
+    windowBlocks = qMax(1, blocks);
+}
+
+int WindowedUpload::window() const {
+    return windowBlocks;
+}
+
+void WindowedUpload::setTimeout(int ms) {
+    timeoutMs = qMax(1, ms);
+}
+
+void WindowedUpload::setMaxRetries(int count) {
+    maxRetries = qMax(0, count);
+}
+
+bool WindowedUpload::isRunning() const {
+    return state != State::Idle;
+}
+
+quint64 WindowedUpload::retransmittedBlocks() const {
+    return retransmitted;
+}
+
+quint32 WindowedUpload::blockCount() const {
+    return quint32((image.size() + blockBytes - 1) / blockBytes);
+}
+
+bool WindowedUpload::start(const QString &filePath) {
+    cancel();
+    // The image is mapped, so only a regular file will do; opening a FIFO could block
+    if (!target || !target->isConnected() || !QFileInfo(filePath).isFile()) {
+        return false;
+    }
+
+    imageFile = new QFile(filePath, this);
+    if (!imageFile->open(QIODevice::ReadOnly)) {
+        delete imageFile;
+        imageFile = nullptr;
+        return false;
+    }
+    const qint64 size = imageFile->size();
+    if (size > 0) {
+        imageMapping = imageFile->map(0, size);
+        if (!imageMapping || (size + blockBytes - 1) / blockBytes > qint64(NoNak)) {
+            finish(false, QString());
+            return false;
+        }
+        image = QByteArray::fromRawData(reinterpret_cast<const char *>(imageMapping), size);
+    }
+
+    previousDecoder = target->frameDecoder();
+    decoder.reset();
+    target->setFrameDecoder(&decoder);
+    connect(target, &FirmwareUART::frameReceived, this, &WindowedUpload::handleFrame);
+    connect(target, &FirmwareUART::dataSent, this, &WindowedUpload::handleDrained);
+
+    state = State::Starting;
+    base = 0;
+    next = 0;
+    lastNak = NoNak;
+    retries = 0;
+    retransmitted = 0;
+
+    imageCrc = crc32(image.constData(), image.size());
+    if (!sendStart()) {
+        return false;
+    }
+    armTimer(true);
+    return true;
+}
+
+bool WindowedUpload::sendStart() {
+    QByteArray message(17, Qt::Uninitialized);
+    message[0] = char(Start);
+    qToLittleEndian<quint32>(quint32(blockBytes), message.data() + 1);
+    qToLittleEndian<quint64>(quint64(image.size()), message.data() + 5);
+    qToLittleEndian<quint32>(imageCrc, message.data() + 13);
+    return sendMessage(message);
+}
+
+void WindowedUpload::cancel() {
+    if (isRunning()) {
+        finish(false, "cancelled");
+    }
+}
+
+// Queues the next block if the port has written everything before it; handleDrained()
+// calls back here as each block leaves
+void WindowedUpload::fillWindow() {
+    if (next < blockCount() && next - base < quint32(windowBlocks) && target->transmitPending() == 0) {
+        const qint64 offset = qint64(next) * blockBytes;
+        QByteArray message = header(Data, next);
+        message += QByteArrayView(image.constData() + offset, qMin<qint64>(blockBytes, image.size() - offset));
+        if (!sendMessage(message)) {
+            return;
+        }
+        ++next;
+    }
+    armTimer(false);
+}
+
+// The timeout runs from the last write the port completed, not from when it was queued
+void WindowedUpload::handleDrained() {
+    if (!isRunning()) {
+        return;
+    }
+    armTimer(true);
+    if (state == State::Sending) {
+        fillWindow();
+    }
+}
+
+// Go-back-N: everything from block onwards goes out again
+void WindowedUpload::goBack(quint32 block) {
+    retransmitted += next - block;
+    next = block;
+    fillWindow();
+}
+
+void WindowedUpload::handleFrame(const QByteArray &frame) {
+    if (frame.size() < 2 || state == State::Idle) {
+        return;
+    }
+    const quint8 type = quint8(frame[0]);
+
+    if (type == Done && state == State::Ending) {
+        const bool ok = frame[1] == 0;
+        finish(ok, ok ? QString() : QString("the device reported a checksum mismatch"));
+        return;
+    }
+    if (frame.size() < 5) {
+        return;
+    }
+    const quint32 value = qFromLittleEndian<quint32>(frame.constData() + 1);
+
+    if (type == Ack && state == State::Starting && value == 0) {
+        state = State::Sending;
+        retries = 0;
+        armTimer(true);
+    } else if (type == Ack && state == State::Sending && value > base && value <= next) {
+        base = value;
+        retries = 0;
+        armTimer(true);
+        emit progress(qMin<qint64>(qint64(base) * blockBytes, image.size()), image.size());
+    } else if (type == Nak && state == State::Sending && value >= base && value < next && value != lastNak) {
+        lastNak = value;
+        base = value; // Everything before it arrived
+        goBack(value);
+        return;
+    } else {
+        return;
+    }
+
+    if (base == blockCount()) {
+        state = State::Ending;
+        if (sendMessage(header(End, blockCount()))) {
+            armTimer(true);
+        }
+    } else {
+        fillWindow();
+    }
+}
+
+void WindowedUpload::handleTimeout() {
+    if (++retries > maxRetries) {
+        finish(false, "the device stopped responding");
+        return;
+    }
+
+    switch (state) {
+    case State::Starting:
+        if (sendStart()) {
+            timer->start(timeoutMs);
+        }
+        break;
+    case State::Sending:
+        lastNak = NoNak;
+        goBack(base);
+        timer->start(timeoutMs);
+        break;
+    case State::Ending:
+        if (sendMessage(header(End, blockCount()))) {
+            timer->start(timeoutMs);
+        }
+        break;
+    case State::Idle:
+        break;
+    }
+}
+
+bool WindowedUpload::sendMessage(const QByteArray &message) {
+    if (!target->writeData(decoder.encode(message))) {
+        finish(false, "the port did not accept the data");
+        return false;
+    }
+    return true;
+}
+
+void WindowedUpload::armTimer(bool restart) {
+    if (restart || !timer->isActive()) {
+        timer->start(timeoutMs);
+    }
+}
+
+void WindowedUpload::finish(bool ok, const QString &error) {
+    const bool wasRunning = isRunning();
+    state = State::Idle;
+    timer->stop();
+
+    if (wasRunning && target) {
+        disconnect(target, &FirmwareUART::frameReceived, this, &WindowedUpload::handleFrame);
+        disconnect(target, &FirmwareUART::dataSent, this, &WindowedUpload::handleDrained);
+        target->setFrameDecoder(previousDecoder);
+    }
+    previousDecoder = nullptr;
+
+    image.clear(); // Before unmapping: it points into the mapping
+    if (imageFile) {
+        if (imageMapping) {
+            imageFile->unmap(imageMapping);
+            imageMapping = nullptr;
+        }
+        delete imageFile;
+        imageFile = nullptr;
+    }
+
+    if (wasRunning) {
+        emit finished(ok, error);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef WINDOWEDUPLOAD_H
+#define WINDOWEDUPLOAD_H
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include "library/firmwareuart.h"
+#include "library/framedecoder.h"
+
+// The WindowedUpload class sends a firmware image with a sliding-window (go-back-N)
+// protocol. Up to window() blocks travel unacknowledged, so the line stays busy while
+// acknowledgements are on their way back, instead of idling for a round trip after every
+// block as XMODEM and YMODEM-1K do. Each message is one COBS frame with a CRC-32 trailer:
+//
+//   host -> device   START 0x01  u32 block size, u64 image size, u32 image CRC-32
+//                    DATA  0x02  u32 block index, then the block (the last one may be short)
+//                    END   0x03  u32 block count
+//   device -> host   ACK   0x81  u32 next block expected, cumulative; 0 accepts START
+//                    NAK   0x82  u32 block to resend from; sent once per gap
+//                    DONE  0x83  u8 status, 0 when the image CRC-32 matched
+//
+// Integers are little-endian. The device keeps in-order blocks only. On a NAK, or when
+// nothing is acknowledged for timeout() after the last write left for the port, the host
+// resends from the oldest unacknowledged block. A block is handed to the target only once
+// it has written everything queued before, so the window counts blocks actually sent and a
+// resend never waits behind stale blocks in the transmit buffer, however slow the line.
+// While running it installs its own decoder on the target and restores the previous one
+// when done. The image is memory-mapped, never read into memory whole.
+// Lives on the target's thread.
+class WindowedUpload : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowedUpload(QObject *parent = nullptr);
+    ~WindowedUpload();
+
+    void setTarget(FirmwareUART *uart);     // Not owned
+    void setBlockSize(int bytes);
+    int blockSize() const;
+    void setWindow(int blocks);             // 1 is stop-and-wait
+    int window() const;
+    void setTimeout(int ms);                // Without progress, before resending
+    void setMaxRetries(int count);          // Timeouts in a row before giving up
+
+    bool isRunning() const;
+    quint64 retransmittedBlocks() const;
+
+public slots:
+    bool start(const QString &filePath);
+    void cancel();
+
+signals:
+    void progress(qint64 bytesAcknowledged, qint64 bytesTotal);
+    void finished(bool ok, QString error);
+
+private slots:
+    void handleFrame(const QByteArray &frame);
+    void handleDrained();
+    void handleTimeout();
+
+private:
+    enum class State { Idle, Starting, Sending, Ending };
+
+    enum MessageType : quint8 {
+        Start = 0x01,
+        Data = 0x02,
+        End = 0x03,
+        Ack = 0x81,
+        Nak = 0x82,
+        Done = 0x83
+    };
+
+    quint32 blockCount() const;
+    bool sendStart();
+    void fillWindow();
+    void goBack(quint32 block);
+    bool sendMessage(const QByteArray &message);
+    void armTimer(bool restart);
+    void finish(bool ok, const QString &error);
+
+    FirmwareUART *target;
+    FrameDecoder *previousDecoder;
+    CobsFrameDecoder decoder;
+    QFile *imageFile;
+    uchar *imageMapping;
+    QByteArray image;         // Points into imageMapping
+    State state;
+    int blockBytes;
+    int windowBlocks;
+    int timeoutMs;
+    int maxRetries;
+    int retries;
+    quint32 base;             // Oldest unacknowledged block
+    quint32 next;             // Next block to send
+    quint32 lastNak;          // Ignore repeats of a NAK already acted on
+    quint32 imageCrc;
+    quint64 retransmitted;
+    QTimer *timer;
+
+    static constexpr int DefaultBlockSize = 1024;
+    static constexpr int DefaultWindow = 16;
+    static constexpr int DefaultTimeoutMs = 2000;
+    static constexpr int DefaultMaxRetries = 5;
+    static constexpr quint32 NoNak = 0xFFFFFFFF;
+};
+
+#endif // WINDOWEDUPLOAD_H
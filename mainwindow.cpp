@@ -2,36 +2,105 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QTimer>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
 #include <QMessageBox>
 
 QString dataToSend = "Finance Minister Arun Jaitley Tuesday hit out at former RBI governor Raghuram Rajan for predicting that the next banking crisis would be triggered by MSME lending, saying postmortem is easier than taking action when it was required. Rajan, who had as the chief economist at IMF warned of impending financial crisis of 2008, in a note to a parliamentary committee warned against ambitious credit targets and loan waivers, saying that they could be the sources of next banking crisis. Government should focus on sources of the next crisis, not just the last one. In particular, government should refrain from setting ambitious credit targets or waiving loans. Credit targets are sometimes achieved by abandoning appropriate due diligence, creating the environment for future NPAs,\" Rajan said in the note.\" Both MUDRA loans as well as the Kisan Credit Card, while popular, have to be examined more closely for potential credit risk. Rajan, who was RBI governor for three years till September 2016, is currently.";
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), uart(new FirmwareUART(this)) {
+    : QMainWindow(parent), ui(new Ui::MainWindow), sessions(new SessionManager(0, this)),
+      portMonitor(new PortMonitor(this)),
+      receiveBuffer(new SpscRingBuffer(ReceiveBufferBytes)), captureStore(new CaptureStore),
+      telemetryStore(new TelemetryStore), telemetryParser(new TelemetryParser(telemetryStore)),
+      uart(new FirmwareUART), triggers(nullptr), staleTriggerMatches(false) {
     ui->setupUi(this);
 
+    console = new ConsoleRenderer(ui->txtConsole, this);
+    txSpeedLabel = new QLabel(this);
+    rxSpeedLabel = new QLabel(this);
+    errorStatsLabel = new QLabel(this);
+    logStatsLabel = new QLabel(this);
+    triggerStatsLabel = new QLabel(this);
+    captureStatsLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(txSpeedLabel);
+    ui->statusbar->addPermanentWidget(rxSpeedLabel);
+    ui->statusbar->addPermanentWidget(errorStatsLabel);
+    ui->statusbar->addPermanentWidget(logStatsLabel);
+    ui->statusbar->addPermanentWidget(triggerStatsLabel);
+    ui->statusbar->addPermanentWidget(captureStatsLabel);
+    refreshStatusLabels();
+
     uart->setDataToSend(dataToSend);
+    uart->setReceiveBuffer(receiveBuffer);
+    captureStore->setMaxBytes(qint64(ui->spinBoxCaptureLimit->value()) << 20);
+    uart->setCaptureStore(captureStore);
+    ui->hexView->setStore(captureStore);
+    ui->plotView->setStore(telemetryStore); // Fed once telemetry is switched on in the Plot tab
+
+    // Serial I/O runs on a pool thread so console repaints cannot stall the port.
+    // Calls into uart from here must go through QMetaObject::invokeMethod.
+    consoleSession = sessions->addSession(uart);
+
+    ui->tableSessions->setColumnCount(7);
+    ui->tableSessions->setHorizontalHeaderLabels({"Port", "Baud", "RX bps", "TX bps", "RX bytes", "TX bytes", "Errors"});
+    ui->tableSessions->verticalHeader()->hide();
 
     // Connect signals and slots for UI and UART
     connect(ui->btnConnect, &QPushButton::clicked, this, &MainWindow::toggleConnectDisconnect);
-    connect(uart, &FirmwareUART::transmissionSpeedUpdated, this, &MainWindow::updateTransmissionSpeed);
-    connect(uart, &FirmwareUART::receiveSpeedUpdated, this, &MainWindow::updateReceiveSpeed);
+    connect(uart, &FirmwareUART::transmitProgress, this, &MainWindow::updateTransmitProgress);
     connect(uart, &FirmwareUART::connectionStatusChanged, this, &MainWindow::updateConnectionStatus);
     connect(ui->btnClear,  &QPushButton::clicked, this, &MainWindow::clearConsole);
+    connect(ui->lineEditOffset, &QLineEdit::returnPressed, this, &MainWindow::goToCaptureOffset);
+    connect(ui->spinBoxCaptureLimit, &QSpinBox::valueChanged, this, [this](int megabytes) {
+        captureStore->setMaxBytes(qint64(megabytes) << 20);
+    });
+    // Rotation limits also apply to a log that is already open, from its next batch
+    auto applyLogRotation = [this] {
+        const qint64 bytes = logRotationBytes();
+        const qint64 secs = logRotationSecs();
+        QMetaObject::invokeMethod(uart, [this, bytes, secs] { uart->setLogRotation(bytes, secs); });
+    };
+    connect(ui->spinBoxLogRotateSize, &QSpinBox::valueChanged, this, applyLogRotation);
+    connect(ui->spinBoxLogRotateAge, &QSpinBox::valueChanged, this, applyLogRotation);
+    connect(sessions, &SessionManager::logWriteError, this, [this](int id, const QString &message) {
+        logError = QString("%1: %2").arg(sessions->portName(id), message);
+        refreshStatusLabels();
+    });
+    connect(ui->btnOpenSession, &QPushButton::clicked, this, &MainWindow::openMonitorSession);
+    connect(ui->btnCloseSession, &QPushButton::clicked, this, &MainWindow::closeMonitorSession);
+    connect(ui->btnTriggers, &QPushButton::clicked, this, &MainWindow::loadTriggers);
+    connect(uart, &FirmwareUART::triggerMatched, this, &MainWindow::showTriggerMatch);
+    connect(ui->checkBoxTelemetry, &QCheckBox::toggled, this, &MainWindow::applyTelemetrySettings);
+    connect(ui->lineEditChannels, &QLineEdit::editingFinished, this, &MainWindow::applyTelemetrySettings);
+
+    // Received bytes arrive through receiveBuffer; the signal only wakes us up to drain it
+    connect(uart, &FirmwareUART::receiveBufferReadyRead, this, &MainWindow::drainReceiveBuffer);
 
-    // Connect dataReceived signal to appendReceivedData slot
-    connect(uart, &FirmwareUART::dataReceived, this, &MainWindow::appendReceivedData);
+    // Metrics are polled at a fixed rate rather than pushed per chunk
+    QTimer *statusTimer = new QTimer(this);
+    connect(statusTimer, &QTimer::timeout, this, &MainWindow::refreshStatusLabels);
+    statusTimer->start(StatusRefreshMs);
 
-    // Timer to periodically update the available ports
-    QTimer *timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MainWindow::updateAvailablePorts);
-    timer->start(2000);  // Every 2 seconds
+    // The port list follows hotplug events; sessions on an unplugged port disconnect themselves
+    connect(portMonitor, &PortMonitor::portAdded, this, &MainWindow::updateAvailablePorts);
+    connect(portMonitor, &PortMonitor::portRemoved, this, &MainWindow::updateAvailablePorts);
+    sessions->setPortMonitor(portMonitor);
 
     updateAvailablePorts();
 }
 
 MainWindow::~MainWindow() {
-    delete uart;
+    // Closes every port on its own thread, stops the pool and deletes uart
+    sessions->shutdown();
+
+    delete triggers;
+    delete telemetryParser;
+    delete telemetryStore;
+    delete captureStore;
+    delete receiveBuffer;
     delete ui;
 }
 
@@ -44,46 +113,236 @@ void MainWindow::toggleConnectDisconnect() {
                 QMessageBox::warning(this, "File Path Required", "Please specify a file path for logging.");
                 return;
             }
-            if (!uart->setupLogFile(filePath)) {
+            const LogWriter::Format format = ui->checkBoxBinary->isChecked() ? LogWriter::Format::Binary
+                                                                             : LogWriter::Format::Text;
+            if (!sessions->setupSessionLog(consoleSession, filePath, format, logRotationBytes(),
+                                           logRotationSecs())) {
                 QMessageBox::critical(this, "Logging Error", "Failed to set up log file. Please check the file path.");
                 return;
             }
+            logError.clear();
         } else {
-            uart->closeLogFile();  // Ensure no log file is open if logging is disabled
+            // Ensure no log file is open if logging is disabled
+            QMetaObject::invokeMethod(uart, &FirmwareUART::closeLogFile, Qt::BlockingQueuedConnection);
         }
 
         // Connect to the specified port and baud rate
         QString portName = ui->comboBoxCom->currentText();
         int baudRate = ui->lineEditBaudRate->text().toInt();
-        if (uart->connectToPort(portName, baudRate)) {
+        receiveBuffer->clear(); // Drop anything left over from the previous session
+        const bool portOpened = sessions->connectSession(consoleSession, portName, baudRate);
+        if (portOpened) {
             ui->btnConnect->setText("Disconnect");
         } else {
             QMessageBox::critical(this, "Connection Failed", "Could not connect to the port.");
         }
     } else {
-        uart->disconnectFromPort(); // Disconnect from the port and close any open log file
-        uart->closeLogFile();
+        // Disconnect from the port and close any open log file
+        QMetaObject::invokeMethod(uart, [this] {
+            uart->disconnectFromPort();
+            uart->closeLogFile();
+        }, Qt::BlockingQueuedConnection);
         ui->btnConnect->setText("Connect");
     }
 }
 
 void MainWindow::appendReceivedData(const QByteArray &data) {
-    ui->txtConsole->append(QString::fromUtf8(data));// Display received data in the console
+    console->appendData(data); // Queued for the next console flush
+}
+
+void MainWindow::drainReceiveBuffer() {
+    // Re-arm first so bytes written while we drain raise a fresh wake-up
+    uart->rearmReceiveNotification();
+
+    QByteArray data(receiveBuffer->size(), Qt::Uninitialized);
+    data.resize(receiveBuffer->read(data.data(), data.size()));
+    if (!data.isEmpty()) {
+        appendReceivedData(data);
+    }
+}
+
+void MainWindow::goToCaptureOffset() {
+    bool ok = false;
+    const qint64 offset = ui->lineEditOffset->text().trimmed().toLongLong(&ok, 0); // Base 0 accepts 0x...
+    if (ok) {
+        ui->hexView->scrollToOffset(offset);
+    }
+}
+
+void MainWindow::openMonitorSession() {
+    const QString portName = ui->comboBoxCom->currentText();
+    const int baudRate = ui->lineEditBaudRate->text().toInt();
+
+    // Each extra session logs next to the main log, with the port name added
+    QString logPath;
+    if (ui->radioButtonLog->isChecked() && !ui->lineEditLocation->text().isEmpty()) {
+        const QFileInfo info(ui->lineEditLocation->text());
+        const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+        logPath = info.path() + "/" + info.completeBaseName() + "-" + portName + suffix;
+    }
+    const LogWriter::Format format = ui->checkBoxBinary->isChecked() ? LogWriter::Format::Binary
+                                                                     : LogWriter::Format::Text;
+
+    if (sessions->openSession(portName, baudRate, logPath, format, logRotationBytes(), logRotationSecs()) < 0) {
+        QMessageBox::critical(this, "Connection Failed", "Could not open " + portName + " for monitoring.");
+    }
+    refreshSessionTable();
 }
 
-void MainWindow::updateTransmissionSpeed(double speedBps) {
-    ui->txtConsole->append(QString("Live Transmission Speed: %1 bps").arg(speedBps, 0, 'f', 2));
+qint64 MainWindow::logRotationBytes() const {
+    return qint64(ui->spinBoxLogRotateSize->value()) << 20;
 }
 
-void MainWindow::updateReceiveSpeed(double speedBps) {
-    ui->txtConsole->append(QString("Live Receive Speed: %1 bps").arg(speedBps, 0, 'f', 2));
+qint64 MainWindow::logRotationSecs() const {
+    return qint64(ui->spinBoxLogRotateAge->value()) * 60;
+}
+
+void MainWindow::closeMonitorSession() {
+    const int row = ui->tableSessions->currentRow();
+    const QTableWidgetItem *item = (row >= 0) ? ui->tableSessions->item(row, 0) : nullptr;
+    const int id = item ? item->data(Qt::UserRole).toInt() : 0;
+    if (id == 0 || id == consoleSession) {
+        return; // The totals row, or the console connection, which the Connect button owns
+    }
+    sessions->removeSession(id);
+    refreshSessionTable();
+}
+
+void MainWindow::loadTriggers() {
+    const QString path = QFileDialog::getOpenFileName(this, "Load Triggers", QString(),
+                                                      "Trigger rules (*.txt *.rules);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    TriggerEngine *engine = new TriggerEngine;
+    QString error;
+    if (!engine->loadRules(path, &error) || !engine->compile()) {
+        QMessageBox::critical(this, "Trigger Error",
+                              error.isEmpty() ? QString("No triggers in %1.").arg(path) : error);
+        delete engine;
+        return;
+    }
+
+    // The session feeds its engine on its own thread; swap there, then nothing uses the old one.
+    // Matches the old engine already queued for us are dropped up to the marker posted right
+    // after the swap, which arrives before anything the new engine emits.
+    staleTriggerMatches = true;
+    QMetaObject::invokeMethod(uart, [this, engine] {
+        uart->setTriggerEngine(engine);
+        QMetaObject::invokeMethod(this, [this] { staleTriggerMatches = false; }, Qt::QueuedConnection);
+    }, Qt::BlockingQueuedConnection);
+    console->setTriggerEngine(engine);
+    delete triggers;
+    triggers = engine;
+    refreshStatusLabels();
+}
+
+void MainWindow::applyTelemetrySettings() {
+    QList<QByteArray> names;
+    for (const QString &name : ui->lineEditChannels->text().split(',', Qt::SkipEmptyParts)) {
+        if (!name.trimmed().isEmpty()) {
+            names << name.trimmed().toUtf8();
+        }
+    }
+    const bool enabled = ui->checkBoxTelemetry->isChecked();
+
+    // The parser runs on the session's thread; change it there
+    QMetaObject::invokeMethod(uart, [this, names, enabled] {
+        telemetryParser->setChannelFilter(names);
+        if (enabled && !uart->telemetryParser()) {
+            telemetryParser->reset(); // Drop any partial line from before it was switched off
+        }
+        uart->setTelemetryParser(enabled ? telemetryParser : nullptr);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void MainWindow::showTriggerMatch(int trigger, qint64 offset, qint64 timestampNs) {
+    // Matches queued before a reload carry ids from the previous rules
+    if (staleTriggerMatches || !triggers || trigger < 0 || trigger >= triggers->triggerCount()) {
+        return;
+    }
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(timestampNs / 1000000);
+    ui->statusbar->showMessage(QString("%1 at offset %2, %3")
+                                   .arg(triggers->trigger(trigger).name)
+                                   .arg(offset)
+                                   .arg(time.toString("HH:mm:ss.zzz")));
+}
+
+void MainWindow::refreshSessionTable() {
+    // One row per connected session, then the totals
+    QList<int> ids;
+    for (const int id : sessions->sessionIds()) {
+        if (sessions->session(id)->isConnected()) {
+            ids << id;
+        }
+    }
+    ui->tableSessions->setRowCount(int(ids.size()) + 1);
+
+    auto setRow = [this](int row, int id, const QString &port, const QString &baud,
+                         const SerialMetrics::Snapshot &stats) {
+        const QStringList values = {port, baud,
+                                    QString::number(stats.receive.windowBps, 'f', 0),
+                                    QString::number(stats.transmit.windowBps, 'f', 0),
+                                    QString::number(stats.receive.totalBytes),
+                                    QString::number(stats.transmit.totalBytes),
+                                    QString::number(stats.errors)};
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem *item = ui->tableSessions->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                ui->tableSessions->setItem(row, column, item);
+            }
+            item->setText(values[column]);
+            item->setData(Qt::UserRole, id);
+        }
+    };
+
+    for (int row = 0; row < ids.size(); ++row) {
+        const int id = ids[row];
+        const QString port = sessions->portName(id) + (id == consoleSession ? " (console)" : "");
+        setRow(row, id, port, QString::number(sessions->baudRate(id)), sessions->sessionStats(id));
+    }
+    setRow(int(ids.size()), 0, "Total", QString(), sessions->aggregateStats());
+}
+
+void MainWindow::refreshStatusLabels() {
+    ui->hexView->refresh(); // Cheap when nothing new arrived
+    refreshSessionTable();
+    const SerialMetrics::Snapshot stats = uart->metricsSnapshot();
+    txSpeedLabel->setText(QString("TX: %1 bps").arg(stats.transmit.windowBps, 0, 'f', 0));
+    rxSpeedLabel->setText(QString("RX: %1 bps").arg(stats.receive.windowBps, 0, 'f', 0));
+    errorStatsLabel->setText(QString("Errors: %1, overruns: %2 (%3 bytes dropped)")
+                                 .arg(stats.errors).arg(stats.overruns).arg(stats.droppedBytes));
+    QString logText = QString("Log: %1 queued, %2 written").arg(uart->logBytesQueued()).arg(uart->logBytesWritten());
+    if (!logError.isEmpty()) {
+        logText += ", failed on " + logError; // Logging has likely stopped; the backlog grows until it drops
+    }
+    logStatsLabel->setText(logText);
+    triggerStatsLabel->setText(triggers ? QString("Triggers: %1 matches").arg(triggers->totalMatches())
+                                        : QString());
+    captureStatsLabel->setText(QString("Capture: %1 of %2 MB, %3 bytes not kept")
+                                   .arg(captureStore->size() / 1e6, 0, 'f', 1)
+                                   .arg(captureStore->maxBytes() >> 20)
+                                   .arg(captureStore->droppedBytes()));
+}
+
+void MainWindow::updateTransmitProgress(qint64 bytesSent, qint64 bytesTotal) {
+    ui->statusbar->showMessage(QString("Sent %1 of %2 bytes").arg(bytesSent).arg(bytesTotal));
 }
 
 void MainWindow::updateConnectionStatus(bool isConnected) {
-    // Notify the user if disconnected unexpectedly
+    // Notify the user if disconnected unexpectedly. This is the only dialog for a lost port:
+    // an unplug reaches here too, once the session has closed it on its own thread.
     if (!isConnected && ui->btnConnect->text() == "Disconnect") {
-        QMessageBox::warning(this, "Disconnected", "Lost connection to the device.");
         ui->btnConnect->setText("Connect");
+        const QString portName = sessions->portName(consoleSession);
+        bool present = false;
+        for (const QSerialPortInfo &port : portMonitor->ports()) {
+            present = present || port.portName() == portName;
+        }
+        QMessageBox::warning(this, "Disconnected", present ? QString("Lost connection to the device.")
+                                                           : QString("%1 is no longer available.").arg(portName));
     }
 }
 
@@ -91,8 +350,8 @@ void MainWindow::updateAvailablePorts() {
     // Get the currently selected port
     QString currentPortName = ui->comboBoxCom->currentText();
 
-    // Get the list of available ports
-    const auto currentPorts = QSerialPortInfo::availablePorts();
+    // Get the list of available ports; cached, so this does not scan the system
+    const auto currentPorts = portMonitor->ports();
 
     // Convert currentPorts and previousPorts to lists of port names for comparison
     QStringList currentPortNames;
@@ -105,7 +364,8 @@ void MainWindow::updateAvailablePorts() {
         previousPortNames << port.portName();
     }
 
-    // If available ports changed, update the combo box and notify if the current port is disconnected
+    // If available ports changed, update the combo box; losing the connected port is reported
+    // by updateConnectionStatus()
     if (currentPortNames != previousPortNames) {
         // Clear and repopulate the combo box
         ui->comboBoxCom->clear();
@@ -117,9 +377,6 @@ void MainWindow::updateAvailablePorts() {
         int index = ui->comboBoxCom->findText(currentPortName);
         if (index != -1) {
             ui->comboBoxCom->setCurrentIndex(index);
-        } else if (uart->isConnected()) {
-            // Notify the user only if there was an active connection
-            QMessageBox::information(this, "Port Disconnected", "The selected COM port is no longer available.");
         }
 
         // Update the previousPorts list with the current list
@@ -129,6 +386,10 @@ void MainWindow::updateAvailablePorts() {
 
 void MainWindow::clearConsole()
 {
-    ui->txtConsole->clear(); // Clear all output in the console
+    console->clear(); // Clear all output in the console, including text not yet flushed
+    captureStore->clear();
+    ui->hexView->refresh();
+    telemetryStore->clear();
+    ui->plotView->update();
 }
 
@@ -3,7 +3,16 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QLabel>
+#include "library/capturestore.h"
+#include "library/consolerenderer.h"
 #include "library/firmwareuart.h"
+#include "library/portmonitor.h"
+#include "library/sessionmanager.h"
+#include "library/spscringbuffer.h"
+#include "library/telemetryparser.h"
+#include "library/telemetrystore.h"
+#include "library/triggerengine.h"
 
 namespace Ui {
 class MainWindow;
@@ -19,17 +28,47 @@ public:
 
 private slots:
     void toggleConnectDisconnect();                 // Handle connect/disconnect button
-    void updateTransmissionSpeed(double speedBps);  // Update UI with transmission speed
-    void updateReceiveSpeed(double speedBps);       // Update UI with receive speed
+    void updateTransmitProgress(qint64 bytesSent, qint64 bytesTotal); // Show transfer progress
     void updateConnectionStatus(bool isConnected);  // Update UI on connection status change
     void clearConsole();                            // Clear the console output
     void appendReceivedData(const QByteArray &data);// Append received data to console
+    void drainReceiveBuffer();                      // Pull everything the I/O thread has buffered
+    void goToCaptureOffset();                       // Jump the hex view to the offset typed in
+    void refreshStatusLabels();                     // Show the latest metrics and log stats in the status bar
+    void openMonitorSession();                      // Open the selected port as an extra session
+    void closeMonitorSession();                     // Close the session selected in the table
+    void loadTriggers();                            // Replace the console session's triggers from a rules file
+    void applyTelemetrySettings();                  // Switch the console session's telemetry parser and filter
+    void showTriggerMatch(int trigger, qint64 offset, qint64 timestampNs);
 
 private:
     Ui::MainWindow *ui;
-    FirmwareUART *uart;  // UART object for handling serial communication
+    SessionManager *sessions;      // I/O thread pool running uart and any extra monitored ports
+    PortMonitor *portMonitor;      // Hotplug events for the port list and for open sessions
+    SpscRingBuffer *receiveBuffer; // Received bytes, written by the I/O thread and read here
+    CaptureStore *captureStore;    // Bytes sent and received up to the capture limit, shown by the hex view
+    TelemetryStore *telemetryStore; // Numeric channels parsed from received lines, shown by the plot
+    TelemetryParser *telemetryParser; // Fed on uart's thread while telemetry is switched on
+    FirmwareUART *uart;  // UART object for handling serial communication, lives on an I/O thread
+    int consoleSession;            // Session id of uart within sessions
+    ConsoleRenderer *console;      // Batches and bounds everything shown in txtConsole
+    QLabel *txSpeedLabel;          // Permanent status bar fields, refreshed at a fixed rate
+    QLabel *rxSpeedLabel;
+    QLabel *errorStatsLabel;       // Port errors and receive overruns
+    QLabel *logStatsLabel;         // Bytes queued and written by the log writer, and its last error
+    QString logError;              // Last log write failure of any session, until the console log is reopened
+    QLabel *triggerStatsLabel;     // Matches counted by the console session's triggers
+    QLabel *captureStatsLabel;     // Hex view capture use against its limit
+    TriggerEngine *triggers;       // Fed on uart's thread; null until a rules file is loaded
+    bool staleTriggerMatches;      // Queued matches are from the engine triggers replaced
     QList<QSerialPortInfo> previousPorts;  // Store the last known list of ports
-    void updateAvailablePorts();           // Method to refresh and update the combo box
+    void updateAvailablePorts();           // Refresh the combo box from portMonitor's cached list
+    void refreshSessionTable();            // Per-session and total throughput
+    qint64 logRotationBytes() const;       // Log rotation limits from the SERIAL box, 0 for none
+    qint64 logRotationSecs() const;
+
+    static constexpr qsizetype ReceiveBufferBytes = 1 << 20; // Several seconds at the highest baud rates
+    static constexpr int StatusRefreshMs = 250;              // Status labels update 4 times per second
 };
 
 #endif // MAINWINDOW_H